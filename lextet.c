@@ -28,8 +28,13 @@
    NEIGHBORLY  all vertices are adjacent.
 */
 
+/* the search can be run by several threads (-t).  compile with -pthread. */
+/* or by a coordinator handing out subtrees to worker processes (-w). */
+
 #define USAGE \
-" lextet [-v] [-h] [-i] [-o o] [-r res -m mod] nv"
+" lextet [-v] [-h] [-i] [-o o] [-manifold] [-exact] [-from n] [-l t|k]\n\
+        [-sig ranges] [-r res -m mod] [-t threads] [-w processes] [-e probes]\n\
+        [-checkpoint file] [-resume file] [-p prefix] nv"
 
 #define HELPTEXT \
 " lextet : generate triangulations of 3-manifolds with nv vertices.\n\
@@ -40,14 +45,45 @@
 \n\
  parameter switches:\n\
    -i          if present only irreducible triangulations are generated\n\
+   -manifold   only 3-manifolds, with the sphere link pruning of lextet\n\
+   -exact      only search for triangulations that are written, those with\n\
+               nv vertices (or at least n with -from).  the ones closed on\n\
+               fewer vertices are pruned, not counted\n\
+   -from n     also write the triangulations with n to nv-1 vertices found\n\
+               in the same search, each nv to its own files\n\
+   -l t        only triangulations whose vertex links are all orientable\n\
+   -l k        only triangulations whose singular vertex links (those that\n\
+               are not spheres) are all non-orientable\n\
+   -sig ranges only triangulations with these numbers of vertex links, as\n\
+               name=n, name=lo:hi, name=lo: or name=:hi separated by commas.\n\
+               names are those of the file names, E2 E1 E0t E0k E91t E91k\n\
+               E92t E92k E93t E93k Eul, and sing for the links that are\n\
+               not spheres.  e.g. -sig sing=:2 or -sig E0t=0,E0k=0\n\
    -r res      res for splitting\n\
    -m mod      mod for splitting\n\
+   -t threads  number of threads sharing the search (default 1)\n\
+   -w processes  number of worker processes doing the subtrees at\n\
+               splitlevel (default 0, no coordinator)\n\
+   -e probes   choose splitlevel from an estimate of the search with this\n\
+               many random probes per degree0 (default 0, no estimate)\n\
+   -checkpoint file  write a checkpoint to file every 10 minutes\n\
+   -resume file      go on with the search from the checkpoint in file\n\
+   -p prefix   only search below the node of the tetrahedra prefix, given in\n\
+               lex format (degree0 is the degree of its first edge)\n\
 \n\
    nv          number of vertices in generated triangulations.\n"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <time.h>
 
 #define CPUTIME 1          /* Whether to measure the cpu time or not */
 
@@ -61,10 +97,12 @@
 #define FALSE 0
 #define TRUE 1
 
-#define MAXN 200
+/* storage class of the search state.  every thread has its own copy. */
+#define THREADLOCAL __thread
+
+#define MAXN 64   /* sets of vertices are kept in one 64 bit word */
 #define MAXE 8400
 #define MAXF MAXN*(MAXN-1)*(MAXN-2)/(3*2)
-#define MAXT 8400
 
 /* BIG macros taken from plantri. */
 /* The program is so fast that the count of output graphs can quickly
@@ -105,12 +143,17 @@ typedef struct
 #define ISEQBIG(big1,big2) (big1.lo == big2.lo && big1.hi == big2.hi)
 
 
+/* a face packs the cofaces in _a and _p, their types and a mark for each
+   orientation in 8 bytes.  vertices are stored in signed chars. */
+
 typedef struct
 {
-  int other_a[2];
-  int type_a[2];  /* 0 = available, 1 = forced, 2 = picked, 
-		   3 = forced then picked */
-  int other_p[2];
+  signed char other_a[2];
+  signed char type_a[2];  /* 0 = available, 1 = forced, 2 = picked, 
+			     3 = forced then picked */
+  signed char other_p[2];
+  unsigned char mark[2];  /* for temporary use;
+			     Only access mark via the MARK macros. */
 } face;
 
 #define AVAILABLE 0
@@ -124,135 +167,277 @@ typedef struct
                           Only access mark via the MARK macros. */
 } vert;
 
-typedef struct
-{
-  int mark;            /* for temporary use;
-                          Only access mark via the MARK macros. */
-} oface;
+/* marks fit in a byte.  the faces are cleared every 255 resets. */
 
-static int markvalue = 30000;
-#define RESETMARKS {int mki; if ((markvalue += 1) > 30000) \
-       { markvalue = 1; for (mki=0;mki<2*maxnf;++mki) ofaces[mki].mark=0; \
+static THREADLOCAL int markvalue = 255;
+#define RESETMARKS {int mki; if ((markvalue += 1) > 255) \
+       { markvalue = 1; for (mki=0;mki<maxnf;++mki) \
+	   faces[mki].mark[0]=faces[mki].mark[1]=0; \
          for (mki=0;mki<maxnv;++mki) verts[mki].mark=0;}}
 #define MARK(e) (e)->mark = markvalue
 #define ISMARKED(e) ((e)->mark >= markvalue)
+#define MARKOFACE(v0,v1,v2) OFACEMARK(v0,v1,v2) = markvalue
+#define ISMARKEDOFACE(v0,v1,v2) (OFACEMARK(v0,v1,v2) >= markvalue)
 
 
-static int maxEuler=0;
+static THREADLOCAL int maxEuler=0;
 
-static int mcount =0;
-static int num7 =0;
-static int num8 =0;
-static int num9 =0;
-static int num10 =0;
-static int num11 =0;
+static THREADLOCAL int mcount =0;
+static THREADLOCAL int num7 =0;
+static THREADLOCAL int num8 =0;
+static THREADLOCAL int num9 =0;
+static THREADLOCAL int num10 =0;
+static THREADLOCAL int num11 =0;
 
-static int EulerChar;
-static int E2;
-static int E1;
-static int E0;
+static THREADLOCAL int EulerChar;
+static THREADLOCAL int E2;
+static THREADLOCAL int E1;
+static THREADLOCAL int E0;
 //These variables represent the quantity of a given singularity type within one triangulation//
 //t=orientable//
 //k=non-orientable//
-static int E0_t;
-static int E0_k;
-static int E91;
-static int E91_t;
-static int E91_k;
-static int E92;
-static int E92_t;
-static int E92_k;
-static int E93_t;
-static int E93_k;
-
-static face faces[MAXF];
-static face *base[MAXN][MAXN][MAXN];
-
-static vert verts[MAXN];
-static vert *vertspt[MAXN];
-static oface ofaces[2*MAXF];
-static oface *ofacespt[MAXN][MAXN][MAXN];
+static THREADLOCAL int E0_t;
+static THREADLOCAL int E0_k;
+static THREADLOCAL int E91;
+static THREADLOCAL int E91_t;
+static THREADLOCAL int E91_k;
+static THREADLOCAL int E92;
+static THREADLOCAL int E92_t;
+static THREADLOCAL int E92_k;
+static THREADLOCAL int E93_t;
+static THREADLOCAL int E93_k;
+
+/* the tables of the search are allocated for each thread by 
+   allocate_search_state().  tables indexed by vertex have maxnv+1 entries 
+   and the lists of tetrahedra have maxlist+1. */
+
+static THREADLOCAL face *faces;                   /* [maxnf] */
+static THREADLOCAL vert *verts;
+static THREADLOCAL vert **vertspt;
+
+/* faceindex is shared by all threads.  for distinct v0,v1,v2 < maxnv, 
+   FACEINDEX(v0,v1,v2) is 2*iface for the face iface = {v0,v1,v2} if 
+   (v0,v1,v2) is an even permutation of the sorted vertices and 2*iface+1 if
+   it is odd.  BASE is the face and OFACEMARK the mark of the face with that
+   orientation. */
+
+static int *faceindex;                           /* [maxnv*maxnv*maxnv] */
+
+#define FACEINDEX(v0,v1,v2) faceindex[((v0)*maxnv+(v1))*maxnv+(v2)]
+#define BASE(v0,v1,v2) (&faces[FACEINDEX(v0,v1,v2)>>1])
+#define OFACEMARK(v0,v1,v2) BASE(v0,v1,v2)->mark[FACEINDEX(v0,v1,v2)&1]
+#define FULLFACE(v0,v1,v2) (BASE(v0,v1,v2)->other_p[1] != -1) /* in _p twice */
 
 static int verbose;
+static int link_kind;  /* 't' or 'k' with -l, 0 for all vertex links */
+static int only_manifolds; /* -manifold: every vertex link is a sphere */
+static int only_exact;     /* -exact: only triangulations with minnv or more 
+			      vertices */
+static int minnv;          /* -from: fewest vertices written, maxnv without */
 static int only_irreducible; /* flag if only irreducible triangulations are to
 				be generated */
-static int nv_a;     /* number of vertices in final triangulation */
-static int ne_a;     /* number of edges in triangulation */
-static int nf_a;     /* number of faces in triangulation */
-static int nt_a;     /* number of tetrahedra in triangulation */
-static int nv_p;     /* number of vertices in final triangulation */
-static int ne_p;     /* number of edges in triangulation */
-static int nf_p;     /* number of faces in triangulation */
-static int nt_p;     /* number of tetrahedra in triangulation */
+static THREADLOCAL int nv_a;     /* number of vertices in final triangulation */
+static THREADLOCAL int ne_a;     /* number of edges in triangulation */
+static THREADLOCAL int nf_a;     /* number of faces in triangulation */
+static THREADLOCAL int nt_a;     /* number of tetrahedra in triangulation */
+static THREADLOCAL int nv_p;     /* number of vertices in final triangulation */
+static THREADLOCAL int ne_p;     /* number of edges in triangulation */
+static THREADLOCAL int nf_p;     /* number of faces in triangulation */
+static THREADLOCAL int nt_p;     /* number of tetrahedra in triangulation */
 static int maxnv;  /* maximum number of vertices in a triangulation */
 static int maxne;  /* maximum number of edges in a triangulation */
 static int maxnf;  /* maximum number of faces in a triangulation */
 static int maxnt;  /* maximum number of tetrahedra in a triangulation */
+static int maxlist; /* maximum number of tetrahedra in a list.  every face is
+		       in at most two tetrahedra. */
 
 /* degreeMN is number of N-complexes containing M-complex, M < N */
 
-static int degree01_a[MAXN]; /* edge degree of vertices, normal degree */
-static int degree02_a[MAXN]; /* face degree at vertex */
-static int degree03_a[MAXN]; /* tetrahedron degree of vertices, number of 
+static THREADLOCAL int *degree01_a; /* edge degree of vertices, normal degree */
+static THREADLOCAL int *degree02_a; /* face degree at vertex */
+static THREADLOCAL int *degree03_a; /* tetrahedron degree of vertices, number of 
 			     tetrahedra with that vertex */
-static int degree12_a[MAXN][MAXN]; /* face degree around an edge 
+static THREADLOCAL int **degree12_a; /* face degree around an edge 
 				    = # of vertices in lk of edge */
-static int degree13_a[MAXN][MAXN]; /* tetrahedron degree around an edge 
+static THREADLOCAL int **degree13_a; /* tetrahedron degree around an edge 
 				    = # edge in lk of edge */
-static int degree01_p[MAXN]; /* edge degree of vertices, normal degree */
-static int degree02_p[MAXN]; /* face degree at vertex */
-static int degree03_p[MAXN]; /* tetrahedron degree of vertices, number of 
+static THREADLOCAL int *degree01_p; /* edge degree of vertices, normal degree */
+static THREADLOCAL int *degree02_p; /* face degree at vertex */
+static THREADLOCAL int *degree03_p; /* tetrahedron degree of vertices, number of 
 			     tetrahedra with that vertex */
-static int degree12_p[MAXN][MAXN]; /* face degree around an edge 
+static THREADLOCAL int **degree12_p; /* face degree around an edge 
 				    = # of vertices in lk of edge */
-static int degree13_p[MAXN][MAXN]; /* tetrahedron degree around an edge 
+static THREADLOCAL int **degree13_p; /* tetrahedron degree around an edge 
 				    = # edge in lk of edge */
-static int complete_a[MAXN]; /* link of vertex is a triangulation of a sphere */
-static int complete_p[MAXN]; /* link of vertex is a triangulation of a sphere */
-static int completeness[MAXN]; /* 0 if not complete, 1 if newly complete, or 
+/* sets of vertices, one bit per vertex */
+
+typedef unsigned long long vset;
+#define BIT(v) (1ULL << (v))
+#define POPCOUNT(s) __builtin_popcountll(s)
+#define FIRSTBIT(s) __builtin_ctzll(s)
+#define BELOW(n) ((n) < MAXN ? BIT(n)-1 : ~0ULL)  /* vertices 0..n-1 */
+#define BETWEEN(lo,hi) (BELOW(hi) & ~BELOW(lo))    /* vertices lo..hi-1 */
+
+static THREADLOCAL vset *edges_a;     /* edges_a[v] = vertices joined to v by 
+					 an edge in _a */
+static THREADLOCAL vset *edges_p;     /* same for _p */
+static THREADLOCAL vset *complete_edges_p; /* vertices joined to v by a 
+					      complete edge in _p, i.e. 
+					      degree12_p == degree13_p != 0 */
+static THREADLOCAL vset complete_verts_p; /* vertices with complete_p */
+
+/* connectivity of the links of the vertices and edges in _p.  each link 
+   has a union-find over its vertices, joined along the tetrahedra.  union 
+   by rank without path compression, so the trail undoes it. */
+
+static THREADLOCAL signed char *vlink_parent; /* VLINK(v) is the row of v */
+static THREADLOCAL signed char *vlink_rank;
+static THREADLOCAL int *vlink_ncomp;          /* components of lk(v) */
+static THREADLOCAL signed char *elink_parent; /* ELINK(v0,v1) is the row of 
+						 the edge (v0,v1) */
+static THREADLOCAL signed char *elink_rank;
+static THREADLOCAL int **elink_ncomp;         /* ELINKCOMP(v0,v1) = 
+						 components of lk(v0,v1) */
+/* the link of an edge in _a is a union of paths while the edge is open.
+   elink_end_a[ELINK(v0,v1)+w] is the other end of the path of lk(v0,v1) 
+   that ends at w, and w itself while w is not in the link.  the value at 
+   an inner vertex of a path is stale. */
+
+static THREADLOCAL signed char *elink_end_a;
+
+#define VLINK(v) ((v)*maxnv)
+#define ELINK(v0,v1) ((MIN(v0,v1)*maxnv+MAX(v0,v1))*maxnv)
+#define ELINKCOMP(v0,v1) elink_ncomp[MIN(v0,v1)][MAX(v0,v1)]
+
+/* orientation of the links of the vertices in _p.  corner i of the 
+   tetrahedron list_p[t] is the node 4*t+i, the face of the link of 
+   list_p[t][i] in that tetrahedron.  a union-find with parity joins the 
+   nodes of two tetrahedra on a common face, the parity telling whether 
+   the order of list_p has to be reversed in one of them to orient them 
+   alike.  an odd cycle makes the link non-orientable. */
+
+static THREADLOCAL int *orient_parent;
+static THREADLOCAL signed char *orient_rank;
+static THREADLOCAL signed char *orient_flip;  /* parity to the parent */
+static THREADLOCAL int *nonorientable_p;      /* lk(v) has an odd cycle */
+static THREADLOCAL int *face_tet;   /* face_tet[i] = first tetrahedron of 
+				       list_p on faces[i], off the trail */
+
+static THREADLOCAL int *complete_a; /* link of vertex is a triangulation of a sphere */
+static THREADLOCAL int *complete_p; /* link of vertex is a triangulation of a sphere */
+static THREADLOCAL int *completeness; /* 0 if not complete, 1 if newly complete, or 
 				  2 if formerly complete */
 
-static int match[MAXN][120][MAXN]; /* lk(v0) is equivalent to lk(0),
-				      i is an index of the automorphisms of 
-				      this equivalence,
-				      v is mapped to match[v0][i][v] by the 
-				      i-th automorphism */
-static int nmatch[MAXN];   /* number of automorphisms above */
-static int list_a[MAXT][4];  /* list of the vertices in each ordered 
+static THREADLOCAL int *match;  /* [maxnv][120][maxnv]. lk(v0) is equivalent 
+				   to lk(0), i is an index of the automorphisms
+				   of this equivalence,
+				   v is mapped to MATCH(v0,i,v) by the 
+				   i-th automorphism */
+#define MATCH(v0,i,v) match[((v0)*120+(i))*maxnv+(v)]
+static THREADLOCAL int *nmatch;   /* number of automorphisms above */
+static THREADLOCAL int (*list_a)[4];  /* list of the vertices in each ordered 
 			      tetrahedron as added to _a */
-static int list_a_forced[MAXT]; /* the index of the picked tetrahedron which
+static THREADLOCAL int *list_a_forced; /* the index of the picked tetrahedron which
 				   forced this tetrahedron to be added; 
 				   -1 if not forced */
-static int list_p[MAXT][4];  /* list of the vertices in each ordered 
+static THREADLOCAL int (*list_p)[4];  /* list of the vertices in each ordered 
 			      tetrahedron as added to _p */
 
-static bigint ngenerated[MAXN]; /* number of triangulations generated by ne */
-static bigint ngen_all; /* number of triangulations generated */
-static int nt_match;        /* number of tetrahedra matched */
-static int v_to_label[MAXN];/* relabeling of vertices */
-static int label_to_v[MAXN];/* vertex with label*/
-static int next_label;      /* next unused label */
-static int debug_count;
-
-static bigint ncalls_min_lex;
-static int max_inter_nv;
-static bigint closed_link[MAXN]; /* closed_link[i] = number of times i-th 
+/* the trail keeps the old value of every word add_tetrahedron_p and 
+   add_tetrahedron_a change, so that remove_tetrahedron_p only has to 
+   restore them.  the lists, max_inter_nv and the tables of min_lex are not 
+   on the trail. */
+
+typedef struct
+{
+  void *addr;  /* word changed */
+  int size;    /* its size: signed char, int or vset */
+  vset old;    /* its value before the change */
+} undo;
+
+static THREADLOCAL undo *trail;
+static THREADLOCAL int ntrail,trailsize;
+static THREADLOCAL int *mark_p;  /* mark_p[i] = ntrail before list_p[i] was 
+				    added */
+static THREADLOCAL int *mark_a;  /* same for list_a[i] */
+
+#define TRAIL(x) {if (ntrail == trailsize) grow_trail(); \
+    trail[ntrail].addr = &(x); trail[ntrail].size = sizeof(x); \
+    trail[ntrail++].old = (x);}
+#define TRAILSET(x,value) {TRAIL(x); (x) = (value);}
+#define TRAILINC(x) {TRAIL(x); (x)++;}
+
+static THREADLOCAL bigint ngenerated[MAXN]; /* number of triangulations generated by ne */
+static THREADLOCAL bigint ngen_all; /* number of triangulations generated */
+static THREADLOCAL int nt_match;        /* number of tetrahedra matched */
+static THREADLOCAL int *v_to_label;/* relabeling of vertices */
+static THREADLOCAL int *label_to_v;/* vertex with label*/
+static THREADLOCAL int next_label;      /* next unused label */
+static THREADLOCAL int debug_count;
+
+static THREADLOCAL bigint ncalls_min_lex;
+static THREADLOCAL int max_inter_nv;
+static THREADLOCAL bigint closed_link[MAXN]; /* closed_link[i] = number of times i-th 
 				    vertex link is closed */
-static int prev_closed_link;
+static THREADLOCAL int prev_closed_link;
 static int res,mod;        /* res/mod from command line (default 0/1) */
 static char res_text[10];  /* text string for res with padded zeros */
-static int splitlevel,
-           splitcount;     /* used for res/mod splitting */
+static int splitlevel;     /* used for res/mod splitting */
+static THREADLOCAL int splitcount;
+static int maxcand;        /* maximum number of candidates for the next 
+			      tetrahedron */
+static int nthreads;       /* number of threads (-t) */
+static int nprocs;         /* number of worker processes (-w) */
+static int spawnlevel;     /* threads share the candidates of frames with at 
+			      most spawnlevel tetrahedra, and of all frames 
+			      while a thread is idle */
+static int nidle;          /* number of threads waiting for work */
+
+/* with several threads the triangulations found are kept in chunks.  the 
+   chunks are linked in the order the search with one thread would write 
+   them and each chunk is written to the files once all earlier chunks are 
+   complete. */
+
+typedef struct chunk
+{
+  struct chunk *prev,*next;
+  int closed;          /* TRUE once no more triangulations are added */
+  int first_vi;        /* first and last vi counted for closed_link in the */
+  int last_vi;         /* chunk; -1 if none */
+  int nresults;        /* two entries per triangulation: */
+  int maxresults;      /* file name and text */
+  char **results;
+} chunk;
+
+static THREADLOCAL chunk *out_chunk; /* chunk this thread writes to */
+static THREADLOCAL int replaying;    /* TRUE while replay_prefix rebuilds the 
+					state of a stolen frame */
+static int nprobes;                  /* probes for each degree0 (-e) */
+static THREADLOCAL int probing;      /* TRUE while estimating the search */
+static double probe_weight;          /* nodes the current node of a probe 
+					stands for */
+static double est_found;             /* estimated triangulations found */
+static char *checkpoint_name;        /* file for checkpoints, or NULL */
+static int resuming;                 /* TRUE while walking down to the node 
+					of the checkpoint */
+static time_t next_checkpoint;       /* time of the next checkpoint */
 
 #define MAX(x,y) ((x)<(y) ? (y) : (x))
 #define MIN(x,y) ((x)>(y) ? (y) : (x))
 
 #ifdef SPLITTEST
-static int splitcases;
+static THREADLOCAL int splitcases;
 #endif
 
 void found_one();
 void next_tetrahedron();
+void share_candidates(int cand[][4], int ncand, int nt);
+void send_task();
+void probe(int cand[][4], int ncand);
+void write_checkpoint();
+int resume_candidate(int cand[][4], int ncand);
+void lost_checkpoint();
+void note_outfile(char *name);
 
 void error_exit(int errornum)
 {
@@ -334,11 +519,11 @@ void dump_it()
   for (v0=0; v0<nv_a-2; v0++)
     for (v1=v0+1; v1<nv_a-1; v1++)
       for (v2=v1+1; v2<nv_a; v2++)
-	if (base[v0][v1][v2]->other_a[0] != -1) {
+	if (BASE(v0,v1,v2)->other_a[0] != -1) {
 	  nface++;
 	  fprintf(stderr,"(%d,%d,%d) %d %d\n",
 		  v0,v1,v2,
-		  base[v0][v1][v2]->other_a[0],base[v0][v1][v2]->other_a[1]);
+		  BASE(v0,v1,v2)->other_a[0],BASE(v0,v1,v2)->other_a[1]);
 	}
 
   fprintf(stderr,"edge degree:");
@@ -360,31 +545,66 @@ void dump_it()
     error_exit(33);
 }
 
+void grow_trail()
+{
+  /* make room for more entries on the trail */
+
+  trailsize = (trailsize == 0 ? 1024 : 2*trailsize);
+  if ((trail = (undo *) realloc(trail,trailsize*sizeof(undo))) == NULL) {
+    fprintf(stderr,"can't allocate the trail\n");
+    exit(1);
+  }
+}
+
+void undo_trail(int mark)
+{
+  /* restore the words on the trail above mark, last change first */
+
+  undo *u;
+
+  while (ntrail > mark) {
+    u = &trail[--ntrail];
+    switch (u->size) {
+    case sizeof(signed char):
+      *(signed char *) u->addr = u->old;
+      break;
+    case sizeof(int):
+      *(int *) u->addr = u->old;
+      break;
+    default:
+      *(vset *) u->addr = u->old;
+    }
+  }
+}
+
 void add_other_a(int v[3], int vo, int type)
 {
   /* add vertex vo to base (v[0],v[1],v[2]) to make tetrahedron */
 
+  face *f;
   int i;
 
-  if (base[v[0]][v[1]][v[2]]->other_a[0] != -1) {
-    base[v[0]][v[1]][v[2]]->other_a[1] = vo;
-    base[v[0]][v[1]][v[2]]->type_a[1] = type;
+  f = BASE(v[0],v[1],v[2]);
+
+  if (f->other_a[0] != -1) {
+    TRAILSET(f->other_a[1],vo);
+    TRAILSET(f->type_a[1],type);
   }
   else {
-    base[v[0]][v[1]][v[2]]->other_a[0] = vo;
-    base[v[0]][v[1]][v[2]]->type_a[0] = type;
+    TRAILSET(f->other_a[0],vo);
+    TRAILSET(f->type_a[0],type);
     
-    nf_a++;
+    TRAILINC(nf_a);
     
     for (i=0; i<3; i++)
-      degree02_a[v[i]]++;
-
-    degree12_a[v[0]][v[1]]++;
-    degree12_a[v[1]][v[0]]++;
-    degree12_a[v[0]][v[2]]++;
-    degree12_a[v[2]][v[0]]++;
-    degree12_a[v[1]][v[2]]++;
-    degree12_a[v[2]][v[1]]++;
+      TRAILINC(degree02_a[v[i]]);
+
+    TRAILINC(degree12_a[v[0]][v[1]]);
+    TRAILINC(degree12_a[v[1]][v[0]]);
+    TRAILINC(degree12_a[v[0]][v[2]]);
+    TRAILINC(degree12_a[v[2]][v[0]]);
+    TRAILINC(degree12_a[v[1]][v[2]]);
+    TRAILINC(degree12_a[v[2]][v[1]]);
   }
 }
 
@@ -392,27 +612,228 @@ void add_other_p(int v[3], int vo)
 {
   /* add vertex vo to base (v[0],v[1],v[2]) to make tetrahedron */
 
+  face *f;
   int i;
 
-  if (base[v[0]][v[1]][v[2]]->other_p[0] != -1)
-    base[v[0]][v[1]][v[2]]->other_p[1] = vo;
+  f = BASE(v[0],v[1],v[2]);
+
+  if (f->other_p[0] != -1) {
+    TRAILSET(f->other_p[1],vo);
+  }
   else {
-    base[v[0]][v[1]][v[2]]->other_p[0] = vo;
+    TRAILSET(f->other_p[0],vo);
     
-    nf_p++;
+    TRAILINC(nf_p);
+    TRAILINC(ELINKCOMP(v[0],v[1]));
+    TRAILINC(ELINKCOMP(v[0],v[2]));
+    TRAILINC(ELINKCOMP(v[1],v[2]));
     
     for (i=0; i<3; i++)
-      degree02_p[v[i]]++;
+      TRAILINC(degree02_p[v[i]]);
+
+    TRAILINC(degree12_p[v[0]][v[1]]);
+    TRAILINC(degree12_p[v[1]][v[0]]);
+    TRAILINC(degree12_p[v[0]][v[2]]);
+    TRAILINC(degree12_p[v[2]][v[0]]);
+    TRAILINC(degree12_p[v[1]][v[2]]);
+    TRAILINC(degree12_p[v[2]][v[1]]);
+  }
+}
+
+void change_set(vset *s, vset value)
+{
+  /* set *s to value, on the trail if it changes */
+
+  if (*s != value)
+    TRAILSET(*s,value);
+}
+
+void update_sets_a(int v[4])
+{
+  /* update edges_a for the edges of tetrahedron v */
+
+  int i,j;
+
+  for (i=0;i<3;i++)
+    for (j=i+1;j<4;j++) {
+      change_set(&edges_a[v[i]],edges_a[v[i]] | BIT(v[j]));
+      change_set(&edges_a[v[j]],edges_a[v[j]] | BIT(v[i]));
+    }
+}
+
+void update_sets_p(int v[4])
+{
+  /* update the sets of _p for the vertices and edges of tetrahedron v */
+
+  int i,j;
+
+  for (i=0;i<3;i++)
+    for (j=i+1;j<4;j++) {
+      change_set(&edges_p[v[i]],edges_p[v[i]] | BIT(v[j]));
+      change_set(&edges_p[v[j]],edges_p[v[j]] | BIT(v[i]));
+      if (degree12_p[v[i]][v[j]] == degree13_p[v[i]][v[j]]) {
+	change_set(&complete_edges_p[v[i]],complete_edges_p[v[i]] | BIT(v[j]));
+	change_set(&complete_edges_p[v[j]],complete_edges_p[v[j]] | BIT(v[i]));
+      }
+      else {
+	change_set(&complete_edges_p[v[i]],complete_edges_p[v[i]] & ~BIT(v[j]));
+	change_set(&complete_edges_p[v[j]],complete_edges_p[v[j]] & ~BIT(v[i]));
+      }
+    }
+
+  for (i=0;i<4;i++)
+    if (complete_p[v[i]])
+      change_set(&complete_verts_p,complete_verts_p | BIT(v[i]));
+}
+
+int link_root(signed char *parent, int u)
+{
+  /* root of u in the union-find parent */
+
+  while (parent[u] != u)
+    u = parent[u];
+  return u;
+}
+
+void link_union(signed char *parent, signed char *rank, int *ncomp, 
+		int u, int w)
+{
+  /* join u and w in the union-find parent, on the trail */
+
+  int t;
+
+  u = link_root(parent,u);
+  w = link_root(parent,w);
+  if (u == w)
+    return;
+  if (rank[u] < rank[w]) {
+    t = u;
+    u = w;
+    w = t;
+  }
+  TRAILSET(parent[w],u);
+  if (rank[u] == rank[w])
+    TRAILINC(rank[u]);
+  TRAILSET(*ncomp,*ncomp-1);
+}
+
+void update_links_p(int v[4])
+{
+  /* join the vertices of tetrahedron v in the links of its vertices and 
+     edges */
+
+  int i,j,k,l;
+  int o[3];
+
+  for (i=0;i<4;i++) {
+    for (j=0,k=0;j<4;j++)
+      if (j != i)
+	o[k++] = v[j];
+    link_union(vlink_parent+VLINK(v[i]),vlink_rank+VLINK(v[i]),
+	       &vlink_ncomp[v[i]],o[0],o[1]);
+    link_union(vlink_parent+VLINK(v[i]),vlink_rank+VLINK(v[i]),
+	       &vlink_ncomp[v[i]],o[0],o[2]);
+  }
+
+  for (i=0;i<3;i++)
+    for (j=i+1;j<4;j++) {
+      for (k=0; k==i || k==j; k++) ;
+      for (l=k+1; l==i || l==j; l++) ;
+      link_union(elink_parent+ELINK(v[i],v[j]),elink_rank+ELINK(v[i],v[j]),
+		 &ELINKCOMP(v[i],v[j]),v[k],v[l]);
+    }
+}
+
+int orient_root(int u, int *flip)
+{
+  /* root of node u, with the parity of u to it in *flip */
+
+  *flip = 0;
+  while (orient_parent[u] != u) {
+    *flip ^= orient_flip[u];
+    u = orient_parent[u];
+  }
+  return u;
+}
+
+void orient_union(int u, int w, int flip, int v)
+{
+  /* nodes u and w of the link of v have parity flip.  join them, on the 
+     trail, or mark the link of v non-orientable if they disagree */
+
+  int ru,rw,fu,fw,t;
+
+  ru = orient_root(u,&fu);
+  rw = orient_root(w,&fw);
+  if (ru == rw) {
+    if ((fu ^ fw) != flip && !nonorientable_p[v])
+      TRAILSET(nonorientable_p[v],TRUE);
+    return;
+  }
+  if (orient_rank[ru] < orient_rank[rw]) {
+    t = ru;
+    ru = rw;
+    rw = t;
+  }
+  TRAILSET(orient_parent[rw],ru);
+  TRAILSET(orient_flip[rw],fu ^ fw ^ flip);
+  if (orient_rank[ru] == orient_rank[rw])
+    TRAILINC(orient_rank[ru]);
+}
+
+void update_orientation_p(int v[4])
+{
+  /* join the corners of the just added tetrahedron v = list_p[nt_p-1] to 
+     those of the tetrahedra it shares a face with.  the tetrahedra are 
+     listed in increasing order, so the face opposite corner k is induced 
+     with sign (-1)^k and two tetrahedra on a face agree if the signs 
+     differ. */
+
+  int t,t2,k,k2,i,i2,iface;
+  face *f;
+
+  t = nt_p-1;
+  for (i=0;i<4;i++) {
+    orient_parent[4*t+i] = 4*t+i;
+    orient_rank[4*t+i] = 0;
+    orient_flip[4*t+i] = 0;
+  }
 
-    degree12_p[v[0]][v[1]]++;
-    degree12_p[v[1]][v[0]]++;
-    degree12_p[v[0]][v[2]]++;
-    degree12_p[v[2]][v[0]]++;
-    degree12_p[v[1]][v[2]]++;
-    degree12_p[v[2]][v[1]]++;
+  for (k=0;k<4;k++) {
+    iface = FACEINDEX(v[(k+1)%4],v[(k+2)%4],v[(k+3)%4])>>1;
+    f = &faces[iface];
+    if (f->other_p[1] != v[k]) {
+      face_tet[iface] = t;
+      continue;
+    }
+    t2 = face_tet[iface];
+    for (k2=0; list_p[t2][k2] != f->other_p[0]; k2++)
+      ;
+    for (i=0;i<4;i++)
+      if (i != k) {
+	for (i2=0; list_p[t2][i2] != v[i]; i2++)
+	  ;
+	orient_union(4*t+i,4*t2+i2,(k+k2+1)&1,v[i]);
+      }
   }
 }
 
+void join_elink_a(int v0, int v1, int va, int vb)
+{
+  /* the edge (va,vb) of lk(v0,v1) joins the paths ending at va and vb */
+
+  signed char *end;
+  int ea,eb;
+
+  end = elink_end_a+ELINK(v0,v1);
+  ea = end[va];
+  eb = end[vb];
+  if (ea == vb)
+    return;        /* closes the link to a cycle */
+  TRAILSET(end[ea],eb);
+  TRAILSET(end[eb],ea);
+}
+
 void add_tetrahedron_a(int v[4], int type)
 {
   /* add a tetrahedron to 3-manifold */
@@ -428,16 +849,29 @@ void add_tetrahedron_a(int v[4], int type)
   /* check if previously forced */
 
   if (type == PICKED)
-    if (base[vloc[0]][vloc[1]][vloc[2]]->other_a[0] == vloc[3] ||
-	base[vloc[0]][vloc[1]][vloc[2]]->other_a[1] == vloc[3]) {
+    if (BASE(vloc[0],vloc[1],vloc[2])->other_a[0] == vloc[3] ||
+	BASE(vloc[0],vloc[1],vloc[2])->other_a[1] == vloc[3]) {
       for (i=0;i<4;i++)
-	if (base[vloc[0+i]][vloc[1+i]][vloc[2+i]]->other_a[0] == vloc[3+i])
-	  base[vloc[0+i]][vloc[1+i]][vloc[2+i]]->type_a[0] += PICKED;
+	if (BASE(vloc[0+i],vloc[1+i],vloc[2+i])->other_a[0] == vloc[3+i])
+	  TRAILSET(BASE(vloc[0+i],vloc[1+i],vloc[2+i])->type_a[0],
+		   BASE(vloc[0+i],vloc[1+i],vloc[2+i])->type_a[0] + PICKED)
 	else
-	  base[vloc[0+i]][vloc[1+i]][vloc[2+i]]->type_a[1] += PICKED;
+	  TRAILSET(BASE(vloc[0+i],vloc[1+i],vloc[2+i])->type_a[1],
+		   BASE(vloc[0+i],vloc[1+i],vloc[2+i])->type_a[1] + PICKED)
       return;
     }
   
+  mark_a[nt_a] = ntrail;
+
+  /* update the paths of the links of the edges */
+
+  join_elink_a(v[0],v[1],v[2],v[3]);
+  join_elink_a(v[0],v[2],v[1],v[3]);
+  join_elink_a(v[0],v[3],v[1],v[2]);
+  join_elink_a(v[1],v[2],v[0],v[3]);
+  join_elink_a(v[1],v[3],v[0],v[2]);
+  join_elink_a(v[2],v[3],v[0],v[1]);
+
   /* update tetrahedron of faces (23) (12) */
 
   for (i=0;i<4;i++)
@@ -447,23 +881,22 @@ void add_tetrahedron_a(int v[4], int type)
 
   for (i=0;i<4;i++) {
     list_a[nt_a][i] = v[i];
-    degree03_a[v[i]]++;
+    TRAILINC(degree03_a[v[i]]);
   }
   if (type == FORCED)
     list_a_forced[nt_a] = nt_p-1;
   else
     list_a_forced[nt_a] = -1;
 
-  nt_a++;
+  TRAILINC(nt_a);
 
   /* update nv */
-  if(v[1] == nv_a){
-	nv_a++;
-  }	
+  if (v[1] == nv_a)
+    TRAILINC(nv_a);
   if (v[2] == nv_a)
-    nv_a++;
+    TRAILINC(nv_a);
   if (v[3] == nv_a)
-    nv_a++;
+    TRAILINC(nv_a);
   if (nv_a > max_inter_nv)
     max_inter_nv = nv_a;
 
@@ -472,20 +905,23 @@ void add_tetrahedron_a(int v[4], int type)
   for (i=0;i<3;i++)
     for (j=i+1;j<4;j++) {
       if (degree13_a[v[i]][v[j]] == 0) {
-	degree01_a[v[i]]++;
-	degree01_a[v[j]]++;
-	ne_a++;
+	TRAILINC(degree01_a[v[i]]);
+	TRAILINC(degree01_a[v[j]]);
+	TRAILINC(ne_a);
       }
-      degree13_a[v[i]][v[j]]++;
-      degree13_a[v[j]][v[i]]++;
+      TRAILINC(degree13_a[v[i]][v[j]]);
+      TRAILINC(degree13_a[v[j]][v[i]]);
     }
+  update_sets_a(v);
 
-  /* update complete */
+  /* update complete.  min_lex moves completeness from 1 to 2 on the 
+     trail too: with forcing, vertex 0 can be completed deeper in the tree
+     than v[i], and backing out of that node must leave completeness 1 */
 
   for (i=0;i<4;i++)
     if (2*degree02_a[v[i]] == 3*degree03_a[v[i]]) {
-      complete_a[v[i]] = TRUE;
-      completeness[v[i]] = 1;
+      TRAILSET(complete_a[v[i]],TRUE);
+      TRAILSET(completeness[v[i]],1);
     }
   
   //check_it();
@@ -499,6 +935,8 @@ void add_tetrahedron_p(int v[4], int type)
 
   if (type == PICKED) {
     
+    mark_p[nt_p] = ntrail;
+
     /* update tetrahedron of faces (23) (12) */
     
     for (i=0;i<4;i++)
@@ -513,20 +951,20 @@ void add_tetrahedron_p(int v[4], int type)
     
     for (i=0;i<4;i++) {
       list_p[nt_p][i] = v[i];
-      degree03_p[v[i]]++;
+      TRAILINC(degree03_p[v[i]]);
     }
-    nt_p++;
+    TRAILINC(nt_p);
     
     /* update nv */
-    if(v[1] == nv_p){
-	nv_p++;
-   }
-	  if (v[2] == nv_p){
-      nv_p++;
-	  printf("added two new vertices \n");
-	  }
+    if (v[1] == nv_p)
+      TRAILINC(nv_p);
+    if (v[2] == nv_p) {
+      TRAILINC(nv_p);
+      if (!replaying)
+	printf("added two new vertices \n");
+    }
     if (v[3] == nv_p)
-      nv_p++;
+      TRAILINC(nv_p);
     if (nv_p > max_inter_nv)
       max_inter_nv = nv_p;
     
@@ -535,12 +973,14 @@ void add_tetrahedron_p(int v[4], int type)
     for (i=0;i<3;i++)
       for (j=i+1;j<4;j++) {
 	if (degree13_p[v[i]][v[j]] == 0) {
-	  degree01_p[v[i]]++;
-	  degree01_p[v[j]]++;
-	  ne_p++;
+	  TRAILINC(degree01_p[v[i]]);
+	  TRAILINC(degree01_p[v[j]]);
+	  TRAILINC(ne_p);
+	  TRAILINC(vlink_ncomp[v[i]]);
+	  TRAILINC(vlink_ncomp[v[j]]);
 	}
-	degree13_p[v[i]][v[j]]++;
-	degree13_p[v[j]][v[i]]++;
+	TRAILINC(degree13_p[v[i]][v[j]]);
+	TRAILINC(degree13_p[v[j]][v[i]]);
       }
     
     /* update complete */
@@ -548,214 +988,138 @@ void add_tetrahedron_p(int v[4], int type)
 	//links of vertices in normal 3-pseudo-manifolds are 2 manifolds//
     for (i=0;i<4;i++)
       if (2*degree02_p[v[i]] == 3*degree03_p[v[i]])
-	complete_p[v[i]] = TRUE;
+	TRAILSET(complete_p[v[i]],TRUE);
+
+    update_sets_p(v);
+    update_links_p(v);
+    update_orientation_p(v);
   }  
   
   add_tetrahedron_a(v,type);
  	for (i=0; i<maxnv; i++) {
 		v_to_label[i]=-1;
 	}
-	
-  //check_it();
-
-	
 }
 
-void remove_other_a(int v[3], int vo)
+void remove_tetrahedron_p(int type)
 {
-  /* remove vertex vo from base (v[0],v[1],v[2]) */
-  
-  int i;
-
-  if (base[v[0]][v[1]][v[2]]->other_a[1] == vo) {
-    base[v[0]][v[1]][v[2]]->other_a[1] = -1;
-    base[v[0]][v[1]][v[2]]->type_a[1] = AVAILABLE;
-  }
-  else {
-    base[v[0]][v[1]][v[2]]->other_a[0] = -1;
-    base[v[0]][v[1]][v[2]]->type_a[0] = AVAILABLE;
-    nf_a--;
+  /* remove the last tetrahedron added with this type by undoing the 
+     trail.  a picked tetrahedron takes the tetrahedra it forced with it. */
 
-    for (i=0; i<3; i++)
-      degree02_a[v[i]]--;
+  if (type == PICKED)
+    undo_trail(mark_p[nt_p-1]);
+  else
+    undo_trail(mark_a[nt_a-1]);
 
-    degree12_a[v[0]][v[1]]--;
-    degree12_a[v[1]][v[0]]--;
-    degree12_a[v[0]][v[2]]--;
-    degree12_a[v[2]][v[0]]--;
-    degree12_a[v[1]][v[2]]--;
-    degree12_a[v[2]][v[1]]--;
-  }
+  //check_it();
 }
 
-void remove_other_p(int v[3], int vo)
+void *search_table(int n, size_t size)
 {
-  /* remove vertex vo from base (v[0],v[1],v[2]) */
-  
-  int i;
-
-  if (base[v[0]][v[1]][v[2]]->other_p[1] == vo) {
-    base[v[0]][v[1]][v[2]]->other_p[1] = -1;
-  }
-  else {
-    base[v[0]][v[1]][v[2]]->other_p[0] = -1;
-    nf_p--;
+  /* allocate a table of the search of n entries of size bytes, set to 0 */
 
-    for (i=0; i<3; i++)
-      degree02_p[v[i]]--;
+  void *table;
 
-    degree12_p[v[0]][v[1]]--;
-    degree12_p[v[1]][v[0]]--;
-    degree12_p[v[0]][v[2]]--;
-    degree12_p[v[2]][v[0]]--;
-    degree12_p[v[1]][v[2]]--;
-    degree12_p[v[2]][v[1]]--;
+  if ((table = calloc(n,size)) == NULL) {
+    fprintf(stderr,"can't allocate the tables of the search\n");
+    exit(1);
   }
+  return table;
 }
 
-void remove_tetrahedron_a(int type, int v[4])
+int **search_matrix()
 {
-  int i,j;
-  int vloc[7];
-
-  for (i=0;i<4;i++)
-    vloc[i] = v[i];
-  for (i=0;i<3;i++)
-    vloc[i+4] = v[i];
-  
-  if (type == PICKED)
-    if ((base[v[0]][v[1]][v[2]]->other_a[0] == v[3] &&
-	 base[v[0]][v[1]][v[2]]->type_a[0] == FORCED_PICKED) ||
-	(base[v[0]][v[1]][v[2]]->other_a[1] == v[3] &&
-	 base[v[0]][v[1]][v[2]]->type_a[1] == FORCED_PICKED)) {
-      
-      for (i=0;i<4;i++)
-	if (base[vloc[i+0]][vloc[i+1]][vloc[i+2]]->other_a[0] == vloc[i+3])
-	  base[vloc[i+0]][vloc[i+1]][vloc[i+2]]->type_a[0] = FORCED;
-	else
-	  base[vloc[i+0]][vloc[i+1]][vloc[i+2]]->type_a[1] = FORCED;
-	
-      return;
-    }
-  
-  /* update list */
-  
-  nt_a--;
-
-  /* update tetrahedron degrees of vertices (03) */
-
-  for (i=0;i<4;i++) {
-    degree03_a[v[i]]--;
-    complete_a[v[i]] = FALSE;
-    completeness[v[i]] = 0;
-  }
-
-  /* update nv */
-
-  if (degree03_a[v[3]] == 0)
-    nv_a--;
-  if (degree03_a[v[2]] == 0)
-    nv_a--;
-
-  /* update degrees of vertices (01) and degrees of edges (13) */
-  
-  for (i=0;i<3;i++)
-    for (j=i+1;j<4;j++) {
-      degree13_a[v[i]][v[j]]--;
-      degree13_a[v[j]][v[i]]--;
-      if (degree13_a[v[i]][v[j]] == 0) {
-	degree01_a[v[i]]--;
-	degree01_a[v[j]]--;
-	ne_a--;
-      }
-    }
+  /* allocate a table of the search indexed by two vertices */
 
-  /* update tetrahedron of faces (23) (12) */
-
-  for (i=0;i<4;i++)
-    remove_other_a(vloc+i,vloc[i+3]);
+  int **rows;
+  int v;
 
-  //check_it();
+  rows = (int **) search_table(maxnv+1,sizeof(int *));
+  rows[0] = (int *) search_table((maxnv+1)*(maxnv+1),sizeof(int));
+  for (v=1; v<=maxnv; v++)
+    rows[v] = rows[v-1] + maxnv+1;
+  return rows;
 }
 
-void remove_tetrahedron_p(int type)
+void allocate_search_state()
 {
-  int i,j;
-  int v[4],vloc[7];
-
-  if (type == PICKED) {
-
-    /* update list */
-    
-    nt_p--;
-    
-    for (i=0;i<4;i++)
-      v[i] = list_p[nt_p][i];
-    
-  //printf("remove %d, %d, %d, %d \n",v[0],v[1],v[2],v[3]);
-    /* update tetrahedron degrees of vertices (03) */
-    
-    for (i=0;i<4;i++) {
-	degree03_p[v[i]]--;
-	complete_p[v[i]] = FALSE;
-    }
-	
-	
-	  
-    /* update nv */
-    
-    if (degree03_p[v[3]] == 0)
-      nv_p--;
-    if (degree03_p[v[2]] == 0)
-      nv_p--;
-    if(degree03_p[v[1]]==0){
-      nv_p--;
-      printf("deleted three vertices in one go \n");	
-    }
-    /* update degrees of vertices (01) and degrees of edges (13) */
-    
-    for (i=0;i<3;i++)
-      for (j=i+1;j<4;j++) {
-	degree13_p[v[i]][v[j]]--;
-	degree13_p[v[j]][v[i]]--;
-	if (degree13_p[v[i]][v[j]] == 0) {
-	  degree01_p[v[i]]--;
-	  degree01_p[v[j]]--;
-	  ne_p--;
-	}
-      }
-	  
+  /* allocate the tables of the search for this thread */
+
+  faces = (face *) search_table(maxnf,sizeof(face));
+  verts = (vert *) search_table(maxnv+1,sizeof(vert));
+  vertspt = (vert **) search_table(maxnv+1,sizeof(vert *));
+
+  degree01_a = (int *) search_table(maxnv+1,sizeof(int));
+  degree02_a = (int *) search_table(maxnv+1,sizeof(int));
+  degree03_a = (int *) search_table(maxnv+1,sizeof(int));
+  degree12_a = search_matrix();
+  degree13_a = search_matrix();
+  degree01_p = (int *) search_table(maxnv+1,sizeof(int));
+  degree02_p = (int *) search_table(maxnv+1,sizeof(int));
+  degree03_p = (int *) search_table(maxnv+1,sizeof(int));
+  degree12_p = search_matrix();
+  degree13_p = search_matrix();
+  edges_a = (vset *) search_table(maxnv+1,sizeof(vset));
+  edges_p = (vset *) search_table(maxnv+1,sizeof(vset));
+  complete_edges_p = (vset *) search_table(maxnv+1,sizeof(vset));
+  vlink_parent = (signed char *) search_table(maxnv*maxnv,1);
+  vlink_rank = (signed char *) search_table(maxnv*maxnv,1);
+  vlink_ncomp = (int *) search_table(maxnv+1,sizeof(int));
+  elink_parent = (signed char *) search_table(maxnv*maxnv*maxnv,1);
+  elink_rank = (signed char *) search_table(maxnv*maxnv*maxnv,1);
+  elink_ncomp = search_matrix();
+  elink_end_a = (signed char *) search_table(maxnv*maxnv*maxnv,1);
+  orient_parent = (int *) search_table(4*(maxlist+1),sizeof(int));
+  orient_rank = (signed char *) search_table(4*(maxlist+1),1);
+  orient_flip = (signed char *) search_table(4*(maxlist+1),1);
+  nonorientable_p = (int *) search_table(maxnv+1,sizeof(int));
+  face_tet = (int *) search_table(maxnf,sizeof(int));
+  complete_a = (int *) search_table(maxnv+1,sizeof(int));
+  complete_p = (int *) search_table(maxnv+1,sizeof(int));
+  completeness = (int *) search_table(maxnv+1,sizeof(int));
+
+  match = (int *) search_table(maxnv*120*maxnv,sizeof(int));
+  nmatch = (int *) search_table(maxnv+1,sizeof(int));
+  v_to_label = (int *) search_table(maxnv+1,sizeof(int));
+  label_to_v = (int *) search_table(maxnv+1,sizeof(int));
+
+  list_a = (int (*)[4]) search_table(maxlist+1,sizeof(list_a[0]));
+  list_a_forced = (int *) search_table(maxlist+1,sizeof(int));
+  mark_a = (int *) search_table(maxlist+1,sizeof(int));
+  mark_p = (int *) search_table(maxlist+1,sizeof(int));
+  list_p = (int (*)[4]) search_table(maxlist+1,sizeof(list_p[0]));
+}
 
-	  
-	
-    /* update tetrahedron of faces (23) (12) */
-    
-    for (i=0;i<4;i++)
-      vloc[i] = v[i];
-    for (i=0;i<3;i++)
-      vloc[i+4] = v[i];
+void make_face_index()
+{
+  /* number the faces {v0,v1,v2}, v0 < v1 < v2, in lex order */
 
-    for (i=0;i<4;i++)
-      remove_other_p(vloc+i,vloc[3+i]);
+  int v0,v1,v2,iface;
 
-    while (list_a_forced[nt_a-1] == nt_p){
-	printf("entered");
-      remove_tetrahedron_a(FORCED,list_a[nt_a-1]);
-    }
-    remove_tetrahedron_a(PICKED,v);
-  }
-  else {
-    remove_tetrahedron_a(FORCED,list_a[nt_a-1]);
+  if ((faceindex = (int *) calloc(maxnv*maxnv*maxnv,sizeof(int))) == NULL) {
+    fprintf(stderr,"can't allocate the tables of the search\n");
+    exit(1);
   }
 
-  //check_it();
+  iface = 0;
+  for (v0=0; v0<maxnv-2; v0++)
+    for (v1=v0+1; v1<maxnv-1; v1++)
+      for (v2=v1+1; v2<maxnv; v2++) {
+	FACEINDEX(v0,v1,v2) = 2*iface;
+	FACEINDEX(v1,v2,v0) = 2*iface;
+	FACEINDEX(v2,v0,v1) = 2*iface;
+	FACEINDEX(v0,v2,v1) = 2*iface+1;
+	FACEINDEX(v1,v0,v2) = 2*iface+1;
+	FACEINDEX(v2,v1,v0) = 2*iface+1;
+	iface++;
+      }
 }
 
 void initialize()
 {
   /* one time initialization */
 
-  int v0,v1,v2,iface,lnv;
+  int v0,lnv;
 
 #ifdef SPLITTEST
   splitcases = 0;
@@ -772,27 +1136,6 @@ void initialize()
   ZEROBIG(ngen_all);
   prev_closed_link = 0;
 
-  iface = 0;
-  for (v0=0; v0<maxnv-2; v0++)
-    for (v1=v0+1; v1<maxnv-1; v1++)
-      for (v2=v1+1; v2<maxnv; v2++) {
-	base[v0][v1][v2] = &faces[iface];
-	base[v0][v2][v1] = &faces[iface];
-	base[v1][v0][v2] = &faces[iface];
-	base[v1][v2][v0] = &faces[iface];
-	base[v2][v0][v1] = &faces[iface];
-	base[v2][v1][v0] = &faces[iface];
-
-	ofacespt[v0][v1][v2] = &ofaces[2*iface];
-	ofacespt[v1][v2][v0] = &ofaces[2*iface];
-	ofacespt[v2][v0][v1] = &ofaces[2*iface];
-	ofacespt[v0][v2][v1] = &ofaces[2*iface+1];
-	ofacespt[v1][v0][v2] = &ofaces[2*iface+1];
-	ofacespt[v2][v1][v0] = &ofaces[2*iface+1];
-
-	iface++;
-      }
-
   for (v0=0; v0<maxnv; v0++) {
     vertspt[v0] = &verts[v0];
   }
@@ -810,20 +1153,31 @@ void initialize_first_edge(int degree0)
   for (v0=0; v0<maxnv-2; v0++)
     for (v1=v0+1; v1<maxnv-1; v1++) 
       for (v2=v1+1; v2<maxnv; v2++) {
-	base[v0][v1][v2]->other_a[0] = -1;
-	base[v0][v1][v2]->other_a[1] = -1;
-	base[v0][v1][v2]->type_a[0] = AVAILABLE;
-	base[v0][v1][v2]->type_a[1] = AVAILABLE;
-	base[v0][v1][v2]->other_p[0] = -1;
-	base[v0][v1][v2]->other_p[1] = -1;
+	BASE(v0,v1,v2)->other_a[0] = -1;
+	BASE(v0,v1,v2)->other_a[1] = -1;
+	BASE(v0,v1,v2)->type_a[0] = AVAILABLE;
+	BASE(v0,v1,v2)->type_a[1] = AVAILABLE;
+	BASE(v0,v1,v2)->other_p[0] = -1;
+	BASE(v0,v1,v2)->other_p[1] = -1;
       }
 
+  for (i=0; i<maxnv*maxnv; i++) {
+    vlink_parent[i] = i%maxnv;
+    vlink_rank[i] = 0;
+  }
+  for (i=0; i<maxnv*maxnv*maxnv; i++) {
+    elink_parent[i] = i%maxnv;
+    elink_rank[i] = 0;
+    elink_end_a[i] = i%maxnv;
+  }
+
   for (v0=0; v0<maxnv; v0++)
     for (v1=0; v1<maxnv; v1++) {
       degree12_a[v0][v1] = 0;
       degree13_a[v0][v1] = 0;
       degree12_p[v0][v1] = 0;
       degree13_p[v0][v1] = 0;
+      elink_ncomp[v0][v1] = 0;
     }
 
   for (v0=0; v0<maxnv; v0++) {
@@ -835,7 +1189,14 @@ void initialize_first_edge(int degree0)
     degree03_p[v0] = 0;
     complete_a[v0] = FALSE;
     complete_p[v0] = FALSE;
+    completeness[v0] = 0;
+    edges_a[v0] = 0;
+    edges_p[v0] = 0;
+    complete_edges_p[v0] = 0;
+    vlink_ncomp[v0] = 0;
+    nonorientable_p[v0] = FALSE;
   }
+  complete_verts_p = 0;
 
   for (v0=0; v0<maxnv; v0++)
     v_to_label[v0] = -1;
@@ -848,6 +1209,7 @@ void initialize_first_edge(int degree0)
   ne_p = 0;
   nf_p = 0;
   nt_p = 0;
+  ntrail = 0;
 
   /* add tetrahedra around first edge */
 
@@ -880,31 +1242,31 @@ int mark_face_np(int *lnf, int *lnv, int *lnb, int v0, int v1, int v2, int v3)
     (*lnv)++;
   }
 
-  if (base[v0][v1][v3]->other_a[0]==v2)
-    v4 = base[v0][v1][v3]->other_a[1];
+  if (BASE(v0,v1,v3)->other_a[0]==v2)
+    v4 = BASE(v0,v1,v3)->other_a[1];
   else
-    v4 = base[v0][v1][v3]->other_a[0];
+    v4 = BASE(v0,v1,v3)->other_a[0];
   if (v4 == -1)
     (*lnb)++;
-  else if (ISMARKED(ofacespt[v3][v1][v4])) 
+  else if (ISMARKEDOFACE(v3,v1,v4)) 
     return TRUE;
-  else if (!ISMARKED(ofacespt[v1][v3][v4])) {
-    MARK(ofacespt[v1][v3][v4]);
+  else if (!ISMARKEDOFACE(v1,v3,v4)) {
+    MARKOFACE(v1,v3,v4);
     (*lnf)++;
     if (mark_face_np(lnf,lnv,lnb,v0,v1,v3,v4))
       return TRUE;
   }
   
-  if (base[v0][v3][v2]->other_a[0]==v1)
-    v4 = base[v0][v3][v2]->other_a[1];
+  if (BASE(v0,v3,v2)->other_a[0]==v1)
+    v4 = BASE(v0,v3,v2)->other_a[1];
   else
-    v4 = base[v0][v3][v2]->other_a[0];
+    v4 = BASE(v0,v3,v2)->other_a[0];
   if (v4 == -1)
     (*lnb)++;
-  else if (ISMARKED(ofacespt[v2][v3][v4])) 
+  else if (ISMARKEDOFACE(v2,v3,v4)) 
     return TRUE;
-  else if (!ISMARKED(ofacespt[v3][v2][v4])) {
-    MARK(ofacespt[v3][v2][v4]);
+  else if (!ISMARKEDOFACE(v3,v2,v4)) {
+    MARKOFACE(v3,v2,v4);
     (*lnf)++;
     if (mark_face_np(lnf,lnv,lnb,v0,v3,v2,v4))
       return TRUE;
@@ -942,28 +1304,28 @@ int nonplanar(int v0, int v1, int v2, int v3)
   MARK(vertspt[v2]);
   MARK(vertspt[v3]);
 
-  v12 = base[v0][v1][v2]->other_a[0];
+  v12 = BASE(v0,v1,v2)->other_a[0];
   if (v12 == -1)
     lnb++;
   else {
     lnf++;
-    MARK(ofacespt[v1][v2][v12]);
+    MARKOFACE(v1,v2,v12);
   }
 
-  v23 = base[v0][v2][v3]->other_a[0];
+  v23 = BASE(v0,v2,v3)->other_a[0];
   if (v23 == -1)
     lnb++;
   else {
     lnf++;
-    MARK(ofacespt[v2][v3][v23]);
+    MARKOFACE(v2,v3,v23);
   }
 
-  v31 = base[v0][v3][v1]->other_a[0];
+  v31 = BASE(v0,v3,v1)->other_a[0];
   if (v31 == -1)
     lnb++;
   else {
     lnf++;
-    MARK(ofacespt[v3][v1][v31]);
+    MARKOFACE(v3,v1,v31);
   }
 
   if (v12 != -1)
@@ -983,6 +1345,35 @@ int nonplanar(int v0, int v1, int v2, int v3)
 }
 
 
+int admissable_link(int v0, int v1, int v2, int v3)
+{
+  /* check if after adding (v0,v1,v2,v3) the link of v0 can still be closed
+     to a surface on at most maxnv-1 vertices.  every face added later 
+     covers at most three of the lnb boundary edges, so the surface has at 
+     least nf + lnb/3 faces, an even number.  a surface with n vertices has
+     3F = 2E <= n(n-1), the bound of Heawood, and Euler characteristic
+     at most n - F/2.  the classes of the file names end at E93, so that 
+     must be at least -3. */
+
+  int nf_v0, ne_v0, lnb, nf_min, n;
+
+  nf_v0 = degree03_p[v0]+1;
+  ne_v0 = degree02_p[v0];
+  if (BASE(v0,v1,v2)->other_p[0] == -1)
+    ne_v0++;
+  if (BASE(v0,v1,v3)->other_p[0] == -1)
+    ne_v0++;
+  if (BASE(v0,v2,v3)->other_p[0] == -1)
+    ne_v0++;
+  lnb = 2*ne_v0 - 3*nf_v0;
+
+  nf_min = nf_v0 + (lnb+2)/3;
+  nf_min += nf_min & 1;
+  n = maxnv-1;
+
+  return 3*nf_min <= n*(n-1) && nf_min <= 2*(n+3);
+}
+
 int admissable_vertex(int v0, int v1, int v2, int v3)
 {
   /* check if adding (v0,v1,v2,v3) would cause the link of v0 to be 
@@ -1015,11 +1406,11 @@ int admissable_vertex(int v0, int v1, int v2, int v3)
     /* v0 should be complete */
 
     ne_v0 = degree02_a[v0];
-    if (base[v0][v1][v2]->other_a[0] == -1)
+    if (BASE(v0,v1,v2)->other_a[0] == -1)
       ne_v0++;
-    if (base[v0][v1][v3]->other_a[0] == -1)
+    if (BASE(v0,v1,v3)->other_a[0] == -1)
       ne_v0++;
-    if (base[v0][v2][v3]->other_a[0] == -1)
+    if (BASE(v0,v2,v3)->other_a[0] == -1)
       ne_v0++;
     if (2*ne_v0 == 3*nf_v0) {
       
@@ -1039,8 +1430,6 @@ int admissable_edge(int v0, int v1, int v2, int v3)
   /* check if adding (v0,v1,v2,v3) would cause the link of (v0,v1) to be 
      a cycle and at least one other edge */
   
-  int va,vb,vc,vd;
-
   /* non pseudo-manifold conditions */
 	//but these conditions remain the same for normal 3-pseudomanifolds//
 	//link of each edge must still be 1-sphere (i.e. a cycle)//
@@ -1051,46 +1440,92 @@ int admissable_edge(int v0, int v1, int v2, int v3)
   if (degree12_a[v0][v1] == degree13_a[v0][v1]+1)
     return TRUE;
   
-  if (base[v0][v1][v2]->other_a[0] == -1)
-    return TRUE;
-  else
-    va = base[v0][v1][v2]->other_a[0];
-  
-  if (base[v0][v1][v3]->other_a[0] == -1)
-    return TRUE;
-  else
-    vb = base[v0][v1][v3]->other_a[0];
-  
-  vc = v2;
-  while (va != vb && va != -1) {
-    if (base[v0][v1][va]->other_a[0] == vc)
-      vd = base[v0][v1][va]->other_a[1];
-    else
-      vd = base[v0][v1][va]->other_a[0];
-    vc = va;
-    va = vd;
-  }
-  
-  if (va == vb)
-    return FALSE;
-  else
-    return TRUE;
+  /* (v2,v3) closes a cycle iff v2 and v3 end the same path */
+
+  return elink_end_a[ELINK(v0,v1)+v2] != v3;
 }
 
-int smaller_lex()
+int previously_forced(int v[4])
 {
-  /* check if the relabeling starting at nt_match is lexigraphically 
-     smaller than the current labeling */
-  
-  int label[4];        /* vertices of tetrahedron. also labels in relabeling */
-  int w0,w1,w2,w3;      /* vertices of tetrahedron relabeled 
-			   (label[0],label[1],label[2],label[3]) */
-  int i;                /* vertex index for tetrahedron */
-  int branch;           /* search might branch */
-  int save_next_label;
-  int save_nt_match;
+  /* check if the tetrahedron v is already in _a */
 
-  branch = FALSE;
+  return BASE(v[0],v[1],v[2])->other_a[0] == v[3] || 
+    BASE(v[0],v[1],v[2])->other_a[1] == v[3];
+}
+
+int admissable_tetrahedron(int v[4])
+{
+  /* check if the tetrahedron v, not in _a, can be added to _a.  each test
+     holds for every triangulation containing _a and v, so a tetrahedron 
+     that fails stays out as more tetrahedra are added. */
+
+  int i,j;
+  int vloc[7];
+
+  for (i=0;i<4;i++)
+    vloc[i] = v[i];
+  for (i=0;i<3;i++)
+    vloc[i+4] = v[i];
+
+  /* check if addition of tetrahedron is blocked by forced tetrahedra */
+    
+  for (i=0; i<4; i++)
+    if (BASE(vloc[i+0],vloc[i+1],vloc[i+2])->other_a[1] != -1)
+      return FALSE;
+    
+  /* check if link of vertex or link of edge is already complete */
+
+  for (i=0; i<4; i++)
+    if (complete_a[v[i]])
+      return FALSE;
+  for (i=0; i<4-1; i++)
+    for (j=i+1; j<4; j++) 
+      if (degree12_a[v[i]][v[j]] != 0 && 
+	  degree12_a[v[i]][v[j]] == degree13_a[v[i]][v[j]])
+	return FALSE;
+
+  /* check that adding tetrahedron would not cause the link of (v[i],v[j]) 
+     to be a cycle and at least one other edge */
+    
+  if (!admissable_edge(v[0],v[1],v[2],v[3]) ||
+      !admissable_edge(v[0],v[2],v[1],v[3]) ||
+      !admissable_edge(v[0],v[3],v[1],v[2]) ||
+      !admissable_edge(v[1],v[2],v[0],v[3]) ||
+      !admissable_edge(v[1],v[3],v[0],v[2]) ||
+      !admissable_edge(v[2],v[3],v[0],v[1]))
+    return FALSE;
+	  
+  /* with -manifold the link of every vertex must stay planar, as in
+     lextet.  a complete planar link is a sphere and so connected. */
+
+  if (only_manifolds)
+    return admissable_vertex(v[0],v[1],v[2],v[3]) &&
+      admissable_vertex(v[1],v[0],v[2],v[3]) &&
+      admissable_vertex(v[2],v[0],v[1],v[3]) &&
+      admissable_vertex(v[3],v[0],v[1],v[2]);
+
+  /* for pseudo-manifolds the link only has to fit in maxnv-1 vertices */
+
+  return admissable_link(v[0],v[1],v[2],v[3]) &&
+    admissable_link(v[1],v[0],v[2],v[3]) &&
+    admissable_link(v[2],v[0],v[1],v[3]) &&
+    admissable_link(v[3],v[0],v[1],v[2]);
+}
+
+int smaller_lex()
+{
+  /* check if the relabeling starting at nt_match is lexigraphically 
+     smaller than the current labeling */
+  
+  int label[4];        /* vertices of tetrahedron. also labels in relabeling */
+  int w0,w1,w2,w3;      /* vertices of tetrahedron relabeled 
+			   (label[0],label[1],label[2],label[3]) */
+  int i;                /* vertex index for tetrahedron */
+  int branch;           /* search might branch */
+  int save_next_label;
+  int save_nt_match;
+
+  branch = FALSE;
 
   for (i=0; i<4; i++)
     label[i] = list_p[nt_match-1][i];
@@ -1122,7 +1557,7 @@ int smaller_lex()
 	  
 	  for (w2=0; w2<nv_a; w2++)
 	    if (v_to_label[w2] == -1) 
-	      if (base[w0][w1][w2]->other_a[0] != -1) {
+	      if (BASE(w0,w1,w2)->other_a[0] != -1) {
 		v_to_label[w2] = next_label;
 		label_to_v[next_label] = w2;
 		save_next_label = next_label;
@@ -1140,35 +1575,35 @@ int smaller_lex()
 	w2 = label_to_v[label[2]];
 	w3 = -1;
 	
-	if (base[w0][w1][w2]->other_a[0] == -1)
+	if (BASE(w0,w1,w2)->other_a[0] == -1)
 	  return FALSE;
 	
 	/* (w0,w1,w2) exists */
 	
-	if (base[w0][w1][w2]->other_a[1] != -1) {
+	if (BASE(w0,w1,w2)->other_a[1] != -1) {
 	  
 	  /* (w0,w1,w2) is complete */
 	  
-	  if (v_to_label[base[w0][w1][w2]->other_a[0]] > label[3] &&
-	      v_to_label[base[w0][w1][w2]->other_a[1]] > label[3]) {
+	  if (v_to_label[BASE(w0,w1,w2)->other_a[0]] > label[3] &&
+	      v_to_label[BASE(w0,w1,w2)->other_a[1]] > label[3]) {
 	    
 	    /* both labels of other vertices could be next so pick smaller */
 	    
-	    if (v_to_label[base[w0][w1][w2]->other_a[0]] > 
-		v_to_label[base[w0][w1][w2]->other_a[1]])
-	      w3 = base[w0][w1][w2]->other_a[1];
+	    if (v_to_label[BASE(w0,w1,w2)->other_a[0]] > 
+		v_to_label[BASE(w0,w1,w2)->other_a[1]])
+	      w3 = BASE(w0,w1,w2)->other_a[1];
 	    else
-	      w3 = base[w0][w1][w2]->other_a[0];
+	      w3 = BASE(w0,w1,w2)->other_a[0];
 	  }
-	  else if (v_to_label[base[w0][w1][w2]->other_a[0]] > label[3])
+	  else if (v_to_label[BASE(w0,w1,w2)->other_a[0]] > label[3])
 	    
 	    /* one label of other vertices could be next so use it */
 	    
-	    w3 = base[w0][w1][w2]->other_a[0];
-	  else if (v_to_label[base[w0][w1][w2]->other_a[1]] > label[3])
-	    w3 = base[w0][w1][w2]->other_a[1];
-	  else if (v_to_label[base[w0][w1][w2]->other_a[0]] == -1) {
-	    if (v_to_label[base[w0][w1][w2]->other_a[1]] == -1)
+	    w3 = BASE(w0,w1,w2)->other_a[0];
+	  else if (v_to_label[BASE(w0,w1,w2)->other_a[1]] > label[3])
+	    w3 = BASE(w0,w1,w2)->other_a[1];
+	  else if (v_to_label[BASE(w0,w1,w2)->other_a[0]] == -1) {
+	    if (v_to_label[BASE(w0,w1,w2)->other_a[1]] == -1)
 	      
 	      /* both final vertices of the tetrahedra of (w0,w1,w2) are 
 		 unlabeled.  the search must branch below */
@@ -1178,17 +1613,17 @@ int smaller_lex()
 	    /* first final vertex of the tetrahedra of (w0,w1,w2) is
 	       unlabeled.  use it. */
 	    
-	    w3 = base[w0][w1][w2]->other_a[0];
+	    w3 = BASE(w0,w1,w2)->other_a[0];
 	    v_to_label[w3] = next_label;
 	    label_to_v[next_label] = w3;
 	    next_label++;
 	  }
-	  else if (v_to_label[base[w0][w1][w2]->other_a[1]] == -1) {
+	  else if (v_to_label[BASE(w0,w1,w2)->other_a[1]] == -1) {
 	    
 	    /* second final vertex of the tetrahedra of (w0,w1,w2) is only
 	       unlabeled.  use it. */
 	    
-	    w3 = base[w0][w1][w2]->other_a[1];
+	    w3 = BASE(w0,w1,w2)->other_a[1];
 	    v_to_label[w3] = next_label;
 	    label_to_v[next_label] = w3;
 	    next_label++;
@@ -1198,10 +1633,10 @@ int smaller_lex()
 	  
 	  /* (w0,w1,w2) exists but is not complete */
 	  
-	  if (v_to_label[base[w0][w1][w2]->other_a[0]] > label[3])
-	    w3 = base[w0][w1][w2]->other_a[0];
-	  else if (v_to_label[base[w0][w1][w2]->other_a[0]] == -1) {
-	    w3 = base[w0][w1][w2]->other_a[0];
+	  if (v_to_label[BASE(w0,w1,w2)->other_a[0]] > label[3])
+	    w3 = BASE(w0,w1,w2)->other_a[0];
+	  else if (v_to_label[BASE(w0,w1,w2)->other_a[0]] == -1) {
+	    w3 = BASE(w0,w1,w2)->other_a[0];
 	    v_to_label[w3] = next_label;
 	    label_to_v[next_label] = w3;
 	    next_label++;
@@ -1230,7 +1665,7 @@ int smaller_lex()
 	    v_to_label[label_to_v[next_label-1]] = -1;
 	  nt_match = save_nt_match;
 	  branch = FALSE;
-	  w3 = base[w0][w1][w2]->other_a[1];
+	  w3 = BASE(w0,w1,w2)->other_a[1];
 	  v_to_label[w3] = next_label;
 	  label_to_v[next_label] = w3;
 	  next_label++;
@@ -1257,7 +1692,7 @@ int smaller_lex()
 	  
 	  for (w2=0; w2<nv_a; w2++)
 	    if (v_to_label[w2] == -1) 
-			if (base[w0][w1][w2]->other_a[0] != -1){
+			if (BASE(w0,w1,w2)->other_a[0] != -1){
 				//printf("TRUE1\n");
 				return TRUE;}
 	}
@@ -1265,17 +1700,17 @@ int smaller_lex()
 	  
 	  w2 = label_to_v[label[2]];
 	  
-	  if (base[w0][w1][w2]->other_a[0] != -1) {
+	  if (BASE(w0,w1,w2)->other_a[0] != -1) {
 	    
 	    /* (w0,w1,w2) exists */
 	    
-	    if (v_to_label[base[w0][w1][w2]->other_a[0]] > label[3] ||
-			v_to_label[base[w0][w1][w2]->other_a[0]] == -1)
+	    if (v_to_label[BASE(w0,w1,w2)->other_a[0]] > label[3] ||
+			v_to_label[BASE(w0,w1,w2)->other_a[0]] == -1)
 			return TRUE;
 	    
-	    if (base[w0][w1][w2]->other_a[1] != -1)
-	      if (v_to_label[base[w0][w1][w2]->other_a[1]] > label[3] ||
-			  v_to_label[base[w0][w1][w2]->other_a[1]] == -1)
+	    if (BASE(w0,w1,w2)->other_a[1] != -1)
+	      if (v_to_label[BASE(w0,w1,w2)->other_a[1]] > label[3] ||
+			  v_to_label[BASE(w0,w1,w2)->other_a[1]] == -1)
 			  return TRUE;
 	  }
 	}
@@ -1305,6 +1740,37 @@ int smaller_lex()
   return FALSE;
 }
 
+int larger_after_star(int v0, int v1, int nafter)
+{
+  /* the relabeling from the complete edge (v0,v1) matches the star of (0,1)
+     and goes on with (0,2,3,x) and (0,2,4,y), x and y the labels of the 
+     fourth vertices of the other tetrahedra of the faces (v0,2,3) and 
+     (v0,2,4).  the current labeling has the first nafter of these two at
+     list_p[degree12_a[0][1]].  return TRUE if the relabeling is larger 
+     there, with the labels as smaller_lex would take them. */
+
+  int d,a,b,x,y,next;
+  face *f;
+
+  d = degree12_a[0][1];
+  next = d+2;
+
+  f = BASE(v0,label_to_v[2],label_to_v[3]);
+  if (f->other_a[1] == -1)
+    return TRUE;
+  a = (f->other_a[0] == v1 ? f->other_a[1] : f->other_a[0]);
+  x = (v_to_label[a] == -1 ? next++ : v_to_label[a]);
+  if (x != list_p[d][3] || nafter == 1)
+    return (x > list_p[d][3]);
+
+  f = BASE(v0,label_to_v[2],label_to_v[4]);
+  if (f->other_a[1] == -1)
+    return TRUE;
+  b = (f->other_a[0] == v1 ? f->other_a[1] : f->other_a[0]);
+  y = (b == a ? x : v_to_label[b] == -1 ? next : v_to_label[b]);
+  return (y > list_p[d+1][3]);
+}
+
 int min_lex()
 {
   /* check that the current labeling of the list of tetrahedra is 
@@ -1315,11 +1781,24 @@ int min_lex()
   int neighbor[MAXN];
   int save_next_label;
   int imatch;
+  int nafter,itet;
 
   ADDBIG(ncalls_min_lex,1);
 
   save_next_label = degree12_a[0][1]+1+1;
 
+  /* the tetrahedra after the star of (0,1) are (0,2,3,x) and (0,2,4,y) 
+     for nearly all nodes.  a relabeling that is larger_after_star is 
+     larger than the current labeling there, before the end of the star of
+     0, so it is neither smaller nor a match and smaller_lex is not 
+     needed. */
+
+  nafter = 0;
+  itet = degree12_a[0][1];
+  while (nafter < 2 && itet+nafter < nt_p && list_p[itet+nafter][0] == 0 &&
+	 list_p[itet+nafter][1] == 2 && list_p[itet+nafter][2] == 3+nafter)
+    nafter++;
+
   for (v0=0; v0<nv_a; v0++) {
     if (completeness[v0] == 1)
       nmatch[v0] = 0;
@@ -1332,18 +1811,18 @@ int min_lex()
 		  
 	    /* make a list of the neighbors of (v0,v1) */
 	    
-	    for (v=0; (v==v0||v==v1?TRUE:base[v0][v1][v]->other_a[0] == -1); v++)
+	    for (v=0; (v==v0||v==v1?TRUE:BASE(v0,v1,v)->other_a[0] == -1); v++)
 	      {}
 	    neighbor[0] = v;
-	    neighbor[1] = base[v0][v1][v]->other_a[0];
+	    neighbor[1] = BASE(v0,v1,v)->other_a[0];
 	    for (ineighbor=2; ineighbor<degree12_a[0][1]; ineighbor++)
-	      if (base[v0][v1][neighbor[ineighbor-1]]->other_a[0] == 
+	      if (BASE(v0,v1,neighbor[ineighbor-1])->other_a[0] == 
 		  neighbor[ineighbor-2])
 		neighbor[ineighbor] = 
-		  base[v0][v1][neighbor[ineighbor-1]]->other_a[1];
+		  BASE(v0,v1,neighbor[ineighbor-1])->other_a[1];
 	      else
 		neighbor[ineighbor] = 
-		  base[v0][v1][neighbor[ineighbor-1]]->other_a[0];
+		  BASE(v0,v1,neighbor[ineighbor-1])->other_a[0];
 	    
 	    /* set the initial values of v_to_label for (v0,v1) */
 	    
@@ -1367,7 +1846,8 @@ int min_lex()
 	      
 	      nt_match = degree12_a[0][1];
 	      next_label = save_next_label;
-	      if (smaller_lex()) {
+	      if ((nafter == 0 || !larger_after_star(v0,v1,nafter)) &&
+		  smaller_lex()) {
 		for ( ; next_label>0; next_label--)
 		  v_to_label[label_to_v[next_label-1]] = -1;
 		return FALSE;
@@ -1378,7 +1858,7 @@ int min_lex()
 	      if (completeness[v0] == 1)
 		if (nt_match >= degree03_a[0]) {
 		  for (v=0; v<=degree01_a[0]; v++)
-		    match[v0][nmatch[v0]][v] = label_to_v[v];
+		    MATCH(v0,nmatch[v0],v) = label_to_v[v];
 		  nmatch[v0]++;
 		}
 	      
@@ -1413,7 +1893,8 @@ int min_lex()
 	      
 	      nt_match = degree12_a[0][1];
 	      next_label = save_next_label;
-	      if (smaller_lex()) {
+	      if ((nafter == 0 || !larger_after_star(v0,v1,nafter)) &&
+		  smaller_lex()) {
 		for ( ; next_label>0; next_label--)
 		  v_to_label[label_to_v[next_label-1]] = -1;
 		return FALSE;
@@ -1424,7 +1905,7 @@ int min_lex()
 	      if (completeness[v0] == 1)
 		if (nt_match >= degree03_a[0]) {
 		  for (v=0; v<=degree01_a[0]; v++)
-		    match[v0][nmatch[v0]][v] = label_to_v[v];
+		    MATCH(v0,nmatch[v0],v) = label_to_v[v];
 		  nmatch[v0]++;
 		}
 	      
@@ -1454,7 +1935,7 @@ int min_lex()
       
       for (imatch=0; imatch<nmatch[v0]; imatch++) {
 	for (v=0; v<=degree01_a[0]; v++) {
-	  label_to_v[v] = match[v0][imatch][v];
+	  label_to_v[v] = MATCH(v0,imatch,v);
 	  v_to_label[label_to_v[v]] = v;
 	}
 	nt_match = degree03_a[0];
@@ -1472,7 +1953,7 @@ int min_lex()
     }
 
     if (complete_p[0] && completeness[v0] == 1)
-      completeness[v0] = 2;
+      TRAILSET(completeness[v0],2);
     
   }
 
@@ -1485,41 +1966,83 @@ int contractible(int v0, int v1)
      complete. */
 
   int v2,v3;
-  int neighbors;  /* number of common neighbors of v0 and v1 */
   int eneighbors;  /* number of common neighboring edges of v0 and v1 */
+  vset common,rest;     /* common neighbors of v0 and v1 */
+
+  common = edges_a[v0] & edges_a[v1] & ~(BIT(v0) | BIT(v1));
+  if (POPCOUNT(common) > degree12_a[v0][v1])
+    return FALSE;
 
-  neighbors = 0;
   eneighbors = 0;
-  for (v2=0; v2<nv_a; v2++)
-    if (v2!=v0 && v2!=v1)
-      if (degree12_a[v0][v2] != 0 && degree12_a[v1][v2] != 0) {
-	neighbors++;
-	if (neighbors == degree12_a[v0][v1]+1)
+  while (common != 0) {
+    v2 = FIRSTBIT(common);
+    common &= common-1;
+    for (rest=common; rest!=0; rest&=rest-1) {
+      v3 = FIRSTBIT(rest);
+      if (BASE(v0,v2,v3)->other_a[0] != -1 && 
+	  BASE(v1,v2,v3)->other_a[0] != -1) {
+	eneighbors++;
+	if (eneighbors == degree12_a[v0][v1]+1)
 	  return FALSE;
-	for (v3=v2+1; v3<nv_a; v3++)
-	  if (v3!=v0 && v3!=v1)
-	    if (base[v0][v2][v3]->other_a[0] != -1 && 
-		base[v1][v2][v3]->other_a[0] != -1) {
-	      eneighbors++;
-	      if (eneighbors == degree12_a[v0][v1]+1)
-		return FALSE;
-	    }
       }
+    }
+  }
   return TRUE;
 }
 
+void add_result(chunk *c, char *s)
+{
+  /* add the allocated string s to the results of chunk c */
+
+  if (c->nresults == c->maxresults) {
+    c->maxresults = 2*c->maxresults + 16;
+    if ((c->results = (char **) realloc(c->results,
+					c->maxresults*sizeof(char *))) == NULL)
+      error_exit(40);
+  }
+  c->results[c->nresults++] = s;
+}
+
+void keep_result(char *outfilename)
+{
+  /* keep the triangulation in the chunk of this thread until it can be
+     written */
+
+  FILE *file;
+  char *text,*name;
+  size_t len;
+
+  if ((name = strdup(outfilename)) == NULL ||
+      (file = open_memstream(&text,&len)) == NULL)
+    error_exit(40);
+  write_lex(file);
+  fclose(file);
+  add_result(out_chunk,name);
+  add_result(out_chunk,text);
+}
+
 void found_one()
 {
   /* found a triangulation */
 
   char outfilename[100];
 	FILE *file;
+  if (probing) {
+    est_found += probe_weight/nprobes;
+    return;
+  }
   ADDBIG(ngenerated[nv_a],1);
   ADDBIG(ngen_all,1);
 	
-	if (nv_p==maxnv) {
+	if (nv_p >= minnv) {
 
 			sprintf(outfilename,"3-manifolds_%dv_%d_%d_%d_%d_%d_%d_%d_%d_%d_%d_Eul%d.lex%c",nv_p,E2,E1,E0_t,E0_k,E91_t,E91_k,E92_t,E92_k,E93_t,E93_k,EulerChar,0);
+			if (out_chunk != NULL) {
+				keep_result(outfilename);
+				return;
+			}
+			if (checkpoint_name != NULL)
+				note_outfile(outfilename);
 			if ((file = fopen(outfilename,"a")) == NULL)
 			{
 				fprintf(stderr,"can't open %s for writing\n",outfilename);
@@ -1553,804 +2076,358 @@ void found_one()
 int force_tetrahedron(int v[4])
 {
   /* check if the just added tetrahedron forces additional tetrahedra to be
-     added.
+     added.  every face ends up in two tetrahedra.  once nv_a == maxnv no 
+     new vertex is left, so the admissable tetrahedra on a face of _a in 
+     one tetrahedron are the only ways to close it: one is forced, none is 
+     a conflict.  the faces of v and of the tetrahedra it forces are 
+     checked in turn, as they are added to list_a.
      if forced tetrahedron lead to a conflict, return FALSE.  
   */
 
+  int it,i,j,k,w,nadmissable,fv[3],t[4],tforce[4],vloc[7];
+  face *f;
+
+  if (nv_a < maxnv)
+    return TRUE;
+
+  for (it=nt_a-1; it<nt_a; it++) {
+    for (i=0;i<4;i++)
+      vloc[i] = list_a[it][i];
+    for (i=0;i<3;i++)
+      vloc[i+4] = list_a[it][i];
+
+    for (i=0; i<4; i++) {
+      f = BASE(vloc[i],vloc[i+1],vloc[i+2]);
+      if (f->other_a[1] != -1)
+	continue;
+      
+      /* the face in order is list_a[it] without vloc[i+3] */
+
+      for (j=0,k=0; j<4; j++)
+	if (list_a[it][j] != vloc[i+3])
+	  fv[k++] = list_a[it][j];
+
+      /* try the tetrahedra (fv[0],fv[1],fv[2],w) in order */
+
+      nadmissable = 0;
+      for (w=0; w<maxnv && nadmissable<2; w++) {
+	if (w == fv[0] || w == fv[1] || w == fv[2] || w == f->other_a[0])
+	  continue;
+	for (j=3; j>0 && fv[j-1]>w; j--)
+	  t[j] = fv[j-1];
+	t[j] = w;
+	for (j--; j>=0; j--)
+	  t[j] = fv[j];
+	if (admissable_tetrahedron(t)) {
+	  nadmissable++;
+	  memcpy(tforce,t,sizeof(t));
+	}
+      }
+
+      if (nadmissable == 0)
+	return FALSE;
+      if (nadmissable == 1)
+	add_tetrahedron_p(tforce,FORCED);
+    }
+  }
+
   /* no conflict */
   
   return TRUE;
 }
 
-//determines the rank of homology//
-int homRank(int vi)
+int orientable_link(int v0)
 {
-	
-	int b;
-	int c;
-	int d;
-	int e;
-	int tetras[nt_p];
-	int counter;
-	int counter1;
-	int flag;
-	int flag1;
-	int seenit;
-	int loop;
-	int loop1;
-	int linkDeg = degree01_p[vi];;
-	
-	counter=0;
-	int a;
-	
-	for (a=0; a<nt_p; a++) {
-		tetras[a]=-1;
-	}
-	
-	//get all tetrahedra that have vi in it//
-	a=0;
-	while(a<nt_p) {
-		flag=0;
-		for (b=0; b<4; b++) {
-			if (list_p[a][b]==vi) {
-				flag=1;
-			}
-		}
-		//if vi is in this tetrahedron then//
-		if (flag==1) {
-			tetras[counter]=a;
-			counter=counter+1;
-		}
-		a++;
-	}
-	
-	
-	int linkVs[counter][nv_p];
-	int vertex;
-	
-	
-	for (loop1=0; loop1<counter; loop1++) {
-		for (loop=0; loop<nv_p; loop++) {
-			linkVs[loop1][loop]=-1;
-		}
-	}
-	
-	for (a=0; a<counter; a++) {
-		vertex=0;
-		for(b=0;b<4;b++){
-			if(list_p[tetras[a]][b]!=vi){
-				linkVs[a][vertex]=list_p[tetras[a]][b];
-				vertex++;
-			}
-		}
-	}
-	
-	int edges[3*counter][2];
-	int faces[counter][3];
-	
-	//fill the faces//
-	for (a=0; a<counter; a++) {
-		for (b=0; b<3; b++) {
-			faces[a][b]=linkVs[a][b];
-		}
-	}
-	
-	
-	//This part is to determine orientability of the linked surface.//
-	int edgeV;
-	int edgeCount;
-	int newEdge;
-	int v1;
-	int v2;
-	edgeCount=0;
-	
-	//get all of the edges//
-	for (a=0; a<counter; a++) {
-		for (b=0; b<3; b++) {
-			newEdge=1;
-			
-			if (b==0) {
-				v1=1;
-				v2=2;
-			}
-			if (b==1) {
-				v1=0;
-				v2=2;
-			}
-			if (b==2) {
-				v1=0;
-				v2=1;
-			}
-			
-			for (c=0; c<edgeCount; c++) {
-				//the second part of this -or- should not really happen i.e. vertices arleady ordered smallest to greatest//
-				//but just in case//
-				if ((edges[c][0]==faces[a][v1] && edges[c][1]==faces[a][v2]) || (edges[c][0]==faces[a][v2] && edges[c][1]==faces[a][v1])) {
-					newEdge=0;
-				}
-			}
-			
-			if(newEdge==1){
-				edgeV=0;
-				for (c=0; c<3; c++) {
-					if (c!=b) {
-						edges[edgeCount][edgeV]=faces[a][c];
-						edgeV++;
-					}
-				}
-				edgeCount++;
-			}
-		}
-	}
-	
-	
-	
-	int homol[edgeCount][counter];
-	for (a=0; a<counter; a++) {//for every face//
-		for (b=0; b<edgeCount; b++) {//for every edge//
-			//for (c=0; c<3; c++) {//for every vertex in face//
-			if((edges[b][0]==faces[a][0] && edges[b][1]==faces[a][1]) || (edges[b][1]==faces[a][0] && edges[b][0]==faces[a][1])){
-				homol[b][a]=1;
-			} 
-			else if((edges[b][0]==faces[a][1] && edges[b][1]==faces[a][2]) || (edges[b][1]==faces[a][1] && edges[b][0]==faces[a][2])){
-				homol[b][a]=1;					
-			}
-			else if((edges[b][0]==faces[a][0] && edges[b][1]==faces[a][2]) || (edges[b][1]==faces[a][0] && edges[b][0]==faces[a][2])){
-				homol[b][a]=-1;
-			}
-			else{
-				homol[b][a]=0;
-			}
-			//}
-		}
-	}
-	
-	
-	int zeroColumn;
-	int pivot;
-	double pivotVal;
-	pivot=0;
-	int tempRow[counter];
-	double difFactor;
-	
-	for (a=0; a<counter; a++) {//for every column//
-		//is it a zero column//
-		zeroColumn=1;
-		for (b=pivot; b<edgeCount; b++) {
-			if (homol[b][a]!=0) {
-				zeroColumn=0;
-			}
-		}
-		if (!zeroColumn) {
-			if (homol[pivot][a]==0) {
-				c=pivot;
-				while (homol[c][a]==0) {
-					c++;
-				}
-				
-				for (d=0; d<counter; d++) {
-					tempRow[d]=homol[pivot][d];
-					homol[pivot][d]=homol[c][d];
-					homol[c][d]=tempRow[d];
-				}
-			}
-			pivotVal=homol[pivot][a];
-			
-			
-			for (b=pivot+1; b<edgeCount; b++) {
-				difFactor = homol[b][a]/pivotVal;
-				for (d=a; d<counter; d++) {
-					homol[b][d]=(homol[b][d]-(difFactor*homol[pivot][d]));
-				}
-			}
-		}
-		
-		pivot++;
-		
-	}
-	
-	int zeroRows;
-	int allZeros;
-	zeroRows=0;
-	for (b=0; b<edgeCount; b++) {
-		allZeros=1;
-		for (a=0; a<counter; a++) {
-			if (homol[b][a]!=0) {
-				//printf("not a zero row: %d\n", b);
-				allZeros=0;
-			}
-		}
-		if (allZeros) {
-			zeroRows++;
-		}
-	}
-	int rank;
-	rank=edgeCount-zeroRows;
-	
-	
-	int Dim;
-	Dim = counter - rank;
+  /* return TRUE if the link of v0, a closed connected surface, is 
+     orientable.  with its Euler characteristic this fixes the surface. */
 
-	return(Dim);
-	
-	//Part to determine orientability of the surface is over//	
+  return !nonorientable_p[v0];
 }
 
 //checks that the link of a vertex is connected//
-int link_connected(int vi){
+int link_connectedEdge(int vi, int vj)
+{
+  /* check that the link of the edge (vi,vj) is connected */
 
+  return ELINKCOMP(vi,vj) == 1;
+}
+
+int link_connected(int vi)
+{
+  /* check that the link of vi is connected.  the links of the edges at vi
+     must be connected as well. */
+
+  vset rest;
+
+  for (rest=edges_p[vi]; rest; rest&=rest-1)
+    if (!link_connectedEdge(vi,FIRSTBIT(rest))) {
+      printf("link of a link not connected!\n");
+      exit(1);
+    }
+
+  return vlink_ncomp[vi] == 1;
+}
+
+/* signature-targeted search (-sig).
+
+   the file of a triangulation is named by the numbers of vertex links of 
+   each kind, and its Euler characteristic, which is the sum of 
+   1 - chi(lk(v))/2.  a complete vertex keeps its link, so the complete 
+   vertices give lower bounds on these numbers.  every other vertex, used 
+   or not yet used, may still end up with any link, except that a link 
+   with an orientation conflict stays non-orientable. */
+
+#define NSIGNATURE 12  /* kinds of links in file name order, then: */
+#define SIG_SING 10    /* links that are not spheres */
+#define SIG_EUL 11     /* Euler characteristic */
+#define SIG_ANY 1000000
+
+static char *sig_names[NSIGNATURE] = {"E2","E1","E0t","E0k","E91t","E91k",
+				"E92t","E92k","E93t","E93k","sing","Eul"};
+static int use_sig;              /* TRUE with -sig */
+static int sig_lo[NSIGNATURE],sig_hi[NSIGNATURE];  /* ranges asked for */
+
+int read_signature(char *text)
+{
+  /* read the ranges of -sig.  return FALSE if the text is bad or a range
+     is empty */
+
+  int i,n;
+  char *p,*end;
+
+  p = text;
+  while (TRUE) {
+    for (i=0; i<NSIGNATURE; i++) {
+      n = strlen(sig_names[i]);
+      if (strncmp(p,sig_names[i],n) == 0 && p[n] == '=')
+	break;
+    }
+    if (i == NSIGNATURE)
+      return FALSE;
+    p += n+1;
+    if (*p != ':') {
+      sig_lo[i] = sig_hi[i] = strtol(p,&end,10);
+      if (end == p)
+	return FALSE;
+      p = end;
+    }
+    if (*p == ':') {
+      p++;
+      sig_hi[i] = SIG_ANY;
+      if (*p != '\0' && *p != ',') {
+	sig_hi[i] = strtol(p,&end,10);
+	if (end == p)
+	  return FALSE;
+	p = end;
+      }
+    }
+    if (sig_lo[i] > sig_hi[i])
+      return FALSE;
+    if (*p == '\0')
+      return TRUE;
+    if (*p++ != ',')
+      return FALSE;
+  }
+}
+
+int link_kind_of(int v)
+{
+  /* index in sig_names of the complete link of v, or -1 if it is beyond 
+     E93 */
+
+  int chi;
+
+  chi = degree01_p[v] - degree02_p[v] + degree03_p[v];
+  if (chi == 2)
+    return 0;
+  if (chi == 1)
+    return 1;
+  if (chi < -3)
+    return -1;
+  return 2 - 2*chi + (nonorientable_p[v] ? 1 : 0);
+}
+
+int signature_possible()
+{
+  /* return FALSE if no triangulation below this node has a signature in 
+     the ranges of -sig.  once every vertex is complete the complex is 
+     closed and written with nv_p vertices, so no new vertex can come in
+     and the signature is the exact one.  that matters with -from. */
+
+  int count[NSIGNATURE],open[NSIGNATURE];
+  int v,i,kind,nfree,nopen,eul_lo,eul_hi;
+
+  for (i=0; i<NSIGNATURE; i++)
+    count[i] = open[i] = 0;
+  nfree = (complete_verts_p == BELOW(nv_p) ? 0 : maxnv - nv_p);
+  nopen = 0;
+  eul_lo = 0;   /* twice the Euler characteristic */
+
+  for (v=0; v<nv_p; v++)
+    if (complete_p[v]) {
+      if ((kind = link_kind_of(v)) >= 0)
+	count[kind]++;
+      if (kind != 0)
+	count[SIG_SING]++;
+      eul_lo += 2 - (degree01_p[v] - degree02_p[v] + degree03_p[v]);
+    }
+    else {
+      nopen++;
+      for (i=0; i<SIG_SING; i++)
+	if (!nonorientable_p[v] || (i & 1))
+	  open[i]++;
+      if (nonorientable_p[v]) {
+	count[SIG_SING]++;
+	eul_lo += 1;
+      }
+      else
+	open[SIG_SING]++;
+    }
+  eul_hi = eul_lo + 5*(nopen + nfree);
+
+  for (i=0; i<=SIG_SING; i++)
+    if (count[i] > sig_hi[i] || count[i] + open[i] + nfree < sig_lo[i])
+      return FALSE;
+
+  return (eul_lo <= 2*sig_hi[SIG_EUL] && eul_hi >= 2*sig_lo[SIG_EUL]);
+}
+
+int minnv_reachable()
+{
+  /* with -exact check that the vertices up to minnv can still come in.  a
+     complete vertex takes no more tetrahedra, so a new vertex only joins 
+     incomplete vertices and the other new ones, and its link has at least
+     degree12_a[0][1]+1 vertices. */
+
+  int nincomplete;
+
+  if (!only_exact || nv_p >= minnv)
+    return TRUE;
+  nincomplete = POPCOUNT(BELOW(nv_p) & ~complete_verts_p);
+  return (nincomplete > 0 && 
+	  nincomplete + maxnv-nv_p-1 >= degree12_a[0][1]+1);
+}
+
+int add_admissable_tetrahedron(int v[4], int type)
+{
+  /* add a new tetrahedron and the tetrahedra it forces, checking the 
+     pruning conditions before and after.  return FALSE, with nothing 
+     added, if one of them fails.  a picked tetrahedron that was previously
+     forced is already in _a.  the search and the replay of a prefix both
+     come through here, so they reach the same nodes. */
+
+  int forced;
+  int vi;
+  int i,j,check_vi;
+
+  forced = (type == PICKED && previously_forced(v));
+
+  /* pruning before adding tetrahedron */
+    
+  if (!forced && !admissable_tetrahedron(v))
+    return FALSE;
+  
+  /* add a new tetrahedron */
+  
+  add_tetrahedron_p(v,type);
 	
-	int b;
-	int c;
-	int d;
-	int e;
-	int tetras[nt_p];
-	int counter;
-	int counter1;
-	int flag;
-	int flag1;
-	int seenit;
-	int loop;
-	int loop1;
-	int linkDeg = degree01_p[vi];;
-	
-	counter=0;
-	int a;
-	
-	for (a=0; a<nt_p; a++) {
-		tetras[a]=-1;
-	}
-	
-	//get all tetrahedra that have vi in it//
-	a=0;
-	while(a<nt_p) {
-		flag=0;
-		for (b=0; b<4; b++) {
-			if (list_p[a][b]==vi) {
-				flag=1;
-			}
-		}
-		//if vi is in this tetrahedron then//
-		if (flag==1) {
-			tetras[counter]=a;
-			counter=counter+1;
-		}
-		a++;
-	}
-	
-	
-	int linkVs[counter][nv_p];
-	int vertex;
-	
-	
-	for (loop1=0; loop1<counter; loop1++) {
-		for (loop=0; loop<nv_p; loop++) {
-			linkVs[loop1][loop]=-1;
-		}
-	}
-	
-	for (a=0; a<counter; a++) {
-		vertex=0;
-		for(b=0;b<4;b++){
-			if(list_p[tetras[a]][b]!=vi){
-				linkVs[a][vertex]=list_p[tetras[a]][b];
-				vertex++;
-			}
-		}
-	}
+  /* check that (0,1) still has minimal degree of complete edges */
+  
+  for (i=0; i<4-1; i++)
+    for (j=i+1; j<4; j++) {
+      if (degree12_a[v[i]][v[j]] == degree13_a[v[i]][v[j]] &&
+	  degree12_a[v[i]][v[j]] < degree12_a[0][1]) {
+	remove_tetrahedron_p(type);
+	return FALSE;
+      }
+    }
+	  
+  //check that if a vertex became complete from this move then its link is connected//  
+  if (!only_manifolds)
+    for (i=0; i<4; i++)
+      if (complete_p[v[i]] && !link_connected(v[i])) {
+	remove_tetrahedron_p(type);
+	return FALSE;
+      }
+
+  /* with -l check the orientation of the vertex links.  a conflict 
+     stays as the link grows; an orientable link is only final once it 
+     is complete, and a sphere is allowed */
+
+  if (link_kind != 0)
+    for (i=0; i<4; i++)
+      if (link_kind == 't' ? nonorientable_p[v[i]] :
+	  (complete_p[v[i]] && !nonorientable_p[v[i]] &&
+	   degree01_p[v[i]] - degree02_p[v[i]] + degree03_p[v[i]] != 2)) {
+	remove_tetrahedron_p(type);
+	return FALSE;
+      }
 
-	int edges[3*counter][2];
-	int faces[counter][3];
+  if (use_sig && !signature_possible()) {
+    remove_tetrahedron_p(type);
+    return FALSE;
+  }
+
+  /* with -exact check that the complex can still reach minnv vertices */
+
+  if (!minnv_reachable()) {
+    remove_tetrahedron_p(type);
+    return FALSE;
+  }
 	
-	//fill the faces//
-	for (a=0; a<counter; a++) {
-		for (b=0; b<3; b++) {
-			faces[a][b]=linkVs[a][b];
+#if !defined NEIGHBORLY
+  
+  /* check for contractible edge */
+  
+  if (only_irreducible && nv_a > 5) 
+    for (i=0; i<4; i++) {
+      if (complete_a[v[i]])
+	for (vi=0; vi<nv_a; vi++) {
+	  if (degree12_a[v[i]][vi] != 0) {
+	    check_vi = TRUE;
+	    for (j=0; check_vi && j<i; j++)
+	      check_vi = (vi != v[j]);
+	    if (check_vi)
+	      if (complete_a[vi])
+		if (contractible(v[i],vi)) {
+		  remove_tetrahedron_p(type);
+		  return FALSE;
 		}
+	  }
 	}
-	
-	
-	//checking links of all vertices in the link of vi//
-	//i.e. links of links//
-	int linkSend[counter][nv_p];
-	int vSend;
-	int init;
-	int newCount;
-	int tetCount;
-	int vDeg;
-	int inbag;
-	int linkVertex;
-	int linkVertexA;
-	
-	for (vSend=0; vSend<nv_p; vSend++) {
-		linkVertex=0;
-		
-		for (c=0; c<counter; c++) {
-			for (d=0; d<nv_p; d++) {
-				if (vSend==linkVs[c][d]) {
-					linkVertex=1;
-				}
-			}
-		}
-		
-		if(vSend!=vi && linkVertex==1){
-		
-		vDeg=0;
-		for (a=0; a<nv_p; a++) {
-			inbag=0;
-			for (c=0; c<counter; c++) {
-				linkVertexA=0;
-				for (d=0; d<nv_p; d++) {
-					if (vSend==linkVs[c][d]) {
-						linkVertexA=1;
-					}
-				}
-				if (linkVertexA==1) {
-					for (d=0; d<nv_p; d++) {
-						if (a==linkVs[c][d]) {
-							inbag=1;
-						}
-					}
-				}
-			}
-			
-			if (inbag==1) {
-				if((degree13_p[vSend][a]>0) && (vSend!=a) && (a!=vi)){
-					vDeg++;
-				}
-			}
-		}
-			
-		tetCount=0;
-		for (a=0; a<counter; a++) {
-			for (b=0; b<nv_p; b++) {
-				linkSend[a][b]=-1;
-			}
-		}
-		//is vSend a vertex in the link of vi//
-		for (a=0; a<counter; a++) {
-			init =0;
-			newCount=0;
-			for(b=0;b<4;b++){
-				if(linkVs[a][b]==vSend){
-					init=1;
-				}
-			}
-			if(init==1){
-				for (b=0; b<4; b++) {
-					if(linkVs[a][b]!=vSend && linkVs[a][b]!=-1 /*&& degree13_p[vSend][linkVs[a][b]]>0*/){
-						if (degree13_p[vSend][linkVs[a][b]]<=0) {
-							printf("degree wrong\n");
-							exit(1);
-						}
-						linkSend[tetCount][newCount]=linkVs[a][b];
-						newCount++;
-					}
-				}
-				tetCount++;
-			}
-		}
-		if (tetCount!=0) {
-			//printf("sending vDeg: %d\n", vDeg);
-			if(!linkOfLink_connected(vSend, linkSend, tetCount, vDeg)){
-				printf("link of a link not connected!\n");
-				exit(1);
-				return FALSE;
-			}
-		}
-		}
-	}
-	
-	
-	
-	int newOne;
-	newOne=3;
-	int connected;
-	int repeat;
-	
-	for(a=0; a<nv_p; a++){
-		if(linkVs[0][a]!=-1){
-			for (b=1; b<counter; b++) {
-				connected = 0;
-				for(c=0;c<4;c++){
-					if (linkVs[0][a]==linkVs[b][c]) {
-						connected = 1;
-					}
-				}
-				if(connected==1){
-					for(d=0;d<4;d++){
-						if (linkVs[b][d]!=vi && linkVs[b][d]!=-1) {
-							repeat = 0;
-							for (e=0; e<newOne; e++) {
-								if(linkVs[0][e]==linkVs[b][d]){
-									repeat=1;
-								}
-							}
-							if (repeat==0) {
-								linkVs[0][newOne]=linkVs[b][d];
-								newOne++;
-							}
-						}
-					}
-				}
-			}
-		}
-	}
-	
-	int final =0;
-	for (a=0; a<nv_p; a++) {
-		if (linkVs[0][a]!=-1) {
-			final++;
-		}
-	}
-	
-	if (newOne==linkDeg) {
-		return TRUE;
-	}
-	else{
-		return FALSE;
-	}
-	
-}
+    }
+  
+#endif
+  
+  /* check if the just added tetrahedron forces additional tetrahedra to be
+     added */
 
-int linkOfLink_connected(int vi, int linkVs[nt_p][nv_p], int counter, int linkDeg){
-	//counter is the number of tetrahedras i.e. linkVs[counter][nv_p]//
-	
-	int b;
-	int c;
-	int d;
-	int e;
-	int tetras[nt_p];
-	int counter1;
-	int flag;
-	int flag1;
-	int seenit;
-	int loop;
-	int loop1;
-	
-	int a;
-	
-	int newOne;
-	int connected;
-	int repeat;
-	
-	
-	
-	newOne=0;
-	int firstNonEmptyTet;
-	firstNonEmptyTet=-1;
-	while(newOne==0){
-		firstNonEmptyTet++;
-		for (a=0; a<nv_p; a++) {
-			if(linkVs[firstNonEmptyTet][a]!=-1){
-				newOne++;
-			}
-		}
-	}
-	
-	if (newOne!=2) {
-		printf("newOne!=2\n");
-		exit(1);
-	}
-	
-	for(a=0; a<nv_p; a++){
-		if(linkVs[firstNonEmptyTet][a]!=-1){
-			for (b=1; b<counter; b++) {
-				connected = 0;
-				for(c=0;c<4;c++){
-					if (linkVs[firstNonEmptyTet][a]==linkVs[b][c]) {
-						connected = 1;
-					}
-				}
-				if(connected==1){
-					for(d=0;d<4;d++){
-						if (linkVs[b][d]!=vi && linkVs[b][d]!=-1) {
-							repeat = 0;
-							for (e=0; e<newOne; e++) {
-								if(linkVs[firstNonEmptyTet][e]==linkVs[b][d]){
-									repeat=1;
-								}
-							}
-							if (repeat==0) {
-								linkVs[firstNonEmptyTet][newOne]=linkVs[b][d];
-								newOne++;
-							}
-						}
-					}
-				}
-			}
-		}
-	}
-	
-	int final =0;
-	for (a=0; a<nv_p; a++) {
-		if (linkVs[firstNonEmptyTet][a]!=-1) {
-			final++;
-		}
-	}
-	
-	if (newOne==linkDeg) {
-		return TRUE;
-	}
-	else{
-		return FALSE;
-	}
-	
-}
+  if (!forced && !force_tetrahedron(v)) {
+    remove_tetrahedron_p(type);
+    return FALSE;
+  }
 
-//this function is never called in the final version//
-//just used for debugging purposes//
-int link_connectedEdge(int vi,int vj){
-	
-	
-	int b;
-	int c;
-	int d;
-	int e;
-	int tetras[nt_p];
-	int counter;
-	int counter1;
-	int flag;
-	int flag1;
-	int seenit;
-	int loop;
-	int loop1;
-	int linkDeg = degree12_p[vi][vj];
-	
-	counter=0;
-	int a;
-	
-	for (a=0; a<nt_p; a++) {
-		tetras[a]=-1;
-	}
-	
-	//get all tetrahedra that have vi in it//
-	a=0;
-	while(a<nt_p) {
-		flag=0;
-		for (b=0; b<4; b++) {
-			if (list_p[a][b]==vi) {
-				for (c=0; c<4; c++) {
-					if(list_p[a][c]==vj){
-						flag=1;
-					}
-				}
-			}
-		}
-		//if vi is in this tetrahedron then//
-		if (flag==1) {
-			tetras[counter]=a;
-			counter=counter+1;
-		}
-		a++;
-	}
-	
-	
-	int linkVs[counter][nv_p];
-	int vertex;
-	
-	
-	for (loop1=0; loop1<counter; loop1++) {
-		for (loop=0; loop<nv_p; loop++) {
-			linkVs[loop1][loop]=-1;
-		}
-	}
-	
-	for (a=0; a<counter; a++) {
-		vertex=0;
-		for(b=0;b<4;b++){
-			if(list_p[tetras[a]][b]!=vi && list_p[tetras[a]][b]!=vj){
-				linkVs[a][vertex]=list_p[tetras[a]][b];
-				vertex++;
-			}
-		}
-	}
-	
-	
-	
-	int newOne;
-	newOne=2;
-	int connected;
-	int repeat;
-	
-	for(a=0; a<nv_p; a++){
-		if(linkVs[0][a]!=-1){
-			for (b=1; b<counter; b++) {
-				connected = 0;
-				for(c=0;c<4;c++){
-					if (linkVs[0][a]==linkVs[b][c]) {
-						connected = 1;
-					}
-				}
-				if(connected==1){
-					for(d=0;d<4;d++){
-						if (linkVs[b][d]!=vi && linkVs[b][d]!=vj && linkVs[b][d]!=-1) {
-							repeat = 0;
-							for (e=0; e<newOne; e++) {
-								if(linkVs[0][e]==linkVs[b][d]){
-									repeat=1;
-								}
-							}
-							if (repeat==0) {
-								linkVs[0][newOne]=linkVs[b][d];
-								newOne++;
-							}
-						}
-					}
-				}
-			}
-		}
-	}
-	
-	int final =0;
-	for (a=0; a<nv_p; a++) {
-		if (linkVs[0][a]!=-1) {
-			final++;
-		}
-	}
-	
-	if (newOne==linkDeg) {
-		return TRUE;
-	}
-	else{
-		return FALSE;
-	}
-	
+  return TRUE;
 }
 
-
-
 int do_tetrahedron(int v[4], int type)
 {
   int done;
   int vi;
-	int vj;
-  int i,j,check_vi;
-  int vloc[7];
-
-  for (i=0;i<4;i++)
-    vloc[i] = v[i];
-  for (i=0;i<3;i++)
-    vloc[i+4] = v[i];
 	
-  /* add a new tetrahedron and check pruning conditions. */
-
-  /* check if new picked tetrahedron was previously forced */
-
-  if (type == PICKED && (base[v[0]][v[1]][v[2]]->other_a[0] == v[3] || base[v[0]][v[1]][v[2]]->other_a[1] == v[3])) {
-	  add_tetrahedron_p(v,type);
-    if (!min_lex()) {
-      remove_tetrahedron_p(type);
-      return FALSE;
-    }
-  }
-  else {
-
-    /* pruning before adding tetrahedron */
-    
-    /* check if addition of tetrahedron is blocked by forced tetrahedra */
-    
-    if (type == PICKED)
-      for (i=0; i<4; i++)
-		  if (base[vloc[i+0]][vloc[i+1]][vloc[i+2]]->other_a[1] != -1)
-			  if (base[vloc[i+0]][vloc[i+1]][vloc[i+2]]->other_a[0] != vloc[i+3] && base[vloc[i+0]][vloc[i+1]][vloc[i+2]]->other_a[1] != vloc[i+3]){
-				  return FALSE;}
-    
-    /* check if link of vertex or link of edge is already complete */
+  /* add a new tetrahedron and check pruning conditions */
 
-    for (i=0; i<4; i++)
-		if (complete_a[v[i]]){
-		  //printf("pruning3 \n");
-
-			return FALSE;}
-    for (i=0; i<4-1; i++)
-      for (j=i+1; j<4; j++) 
-		  if (degree12_a[v[i]][v[j]] != 0 && (degree12_a[v[i]][v[j]] == degree13_a[v[i]][v[j]])){
-			  //printf("pruning4 \n");
+  if (!add_admissable_tetrahedron(v,type))
+    return FALSE;
 
-			  return FALSE;}
+  /* pruning after adding tetrahedron */
 
-    /* check that adding tetrahedron would not cause the link of (v[i],v[j]) 
-       to be a cycle and at least one other edge */
-    
-    if (!admissable_edge(v[0],v[1],v[2],v[3]))
-      return FALSE;
-    if (!admissable_edge(v[0],v[2],v[1],v[3]))
-      return FALSE;
-    if (!admissable_edge(v[0],v[3],v[1],v[2]))
-      return FALSE;
-    if (!admissable_edge(v[1],v[2],v[0],v[3]))
-      return FALSE;
-    if (!admissable_edge(v[1],v[3],v[0],v[2]))
-      return FALSE;
-    if (!admissable_edge(v[2],v[3],v[0],v[1]))
-      return FALSE;
-   
-	  
-	 //what is admissable will have to change//
-	//i.e. if the link of the vertex is now disconnected this is inadmissable//
-	  //but if the link is connected but isn't necessarily a sphere it's admissable//
-   // if (!admissable_vertex(v[0],v[1],v[2],v[3]))
-     // return FALSE;
-    //if (!admissable_vertex(v[1],v[0],v[2],v[3]))
-     // return FALSE;
-    //if (!admissable_vertex(v[2],v[0],v[1],v[3]))
-     // return FALSE;
-    //if (!admissable_vertex(v[3],v[0],v[1],v[2]))
-      //return FALSE;
-    
-    /* add a new tetrahedron */
-    
-    add_tetrahedron_p(v,type);
-	  
-    /* check that (0,1) still has minimal degree of complete edges */
-    
-    for (i=0; i<4-1; i++)
-      for (j=i+1; j<4; j++) {
-	if (degree12_a[v[i]][v[j]] == degree13_a[v[i]][v[j]] &&
-	    degree12_a[v[i]][v[j]] < degree12_a[0][1]) {
-	  remove_tetrahedron_p(type);
-	  return FALSE;
-	}
-      }
-	  
-	  
-	//check that if a vertex became complete from this move then its link is connected//  
-	for (i=0; i<4; i++) {
-		if (complete_p[v[i]]) {
-			if (!link_connected(v[i])) {
-				remove_tetrahedron_p(type);
-				return FALSE;
-			}
-		}
-	}
-	  
-#if !defined NEIGHBORLY
-    
-    /* check for contractible edge */
-    
-    if (only_irreducible && nv_a > 5) 
-      for (i=0; i<4; i++) {
-	if (complete_a[v[i]])
-	  for (vi=0; vi<nv_a; vi++) {
-	    if (degree12_a[v[i]][vi] != 0) {
-	      check_vi = TRUE;
-	      for (j=0; check_vi && j<i; j++)
-		check_vi = (vi != v[j]);
-	      if (check_vi)
-		if (complete_a[vi])
-		  if (contractible(v[i],vi)) {
-		    remove_tetrahedron_p(type);
-		    return FALSE;
-		  }
-	    }
-	  }
-      }
-    
-#endif
-    
-    /* check if the just added tetrahedron forces additional tetrahedra to be
-       added */
-    //force_tetrahedron just always returns TRUE//
-    if (!force_tetrahedron(v)) {
+  if (type == PICKED)
+    if (!min_lex()) {
       remove_tetrahedron_p(type);
       return FALSE;
     }
 
-    /* pruning after adding tetrahedron */
-	  int temporaryThing = 0;
-	  
-	  if (v[0]==0 && v[1]==2 && v[2]==3 && v[3]==5) {
-		  temporaryThing =1;
-	  }
-    if (type == PICKED)
-      if (!min_lex()) {
-			  remove_tetrahedron_p(type);
-			  return FALSE;
-      }
-    
-  }
-
   /* check triangulation is done */
     
   if (type == PICKED) {
@@ -2361,7 +2438,11 @@ int do_tetrahedron(int v[4], int type)
 		//However, now this check is done above, immediately once the link becomes complete//
       done = (complete_p[vi] /*&& (degree01_p[vi] - degree02_p[vi] + degree03_p[vi]<3) && link_connected(vi)*/);
 	}
-	if (vi > prev_closed_link){
+	/* at the start of a chunk the comparison with the previous vi is left
+	   to write_chunks */
+	if (prev_closed_link < 0)
+		out_chunk->first_vi = vi;
+	else if (vi > prev_closed_link){
 		ADDBIG(closed_link[vi],1);
 	}
 	prev_closed_link = vi;
@@ -2417,7 +2498,6 @@ int do_tetrahedron(int v[4], int type)
 			maxEuler=EulerChar;
 		}
 		
-		int homology=-99;
 		for (vi=0; vi<nv_p; vi++){
 			
 			Euler = degree01_p[vi] - degree02_p[vi] + degree03_p[vi];
@@ -2428,54 +2508,47 @@ int do_tetrahedron(int v[4], int type)
 				manifold = 0;
 			}
 		
-			if (Euler>2 && nv_p==maxnv) {
+			if (Euler>2 && nv_p>=minnv) {
 				printf("GOT surfaces with EulerChar>2");
 				exit(1);
 			}
-			if (Euler==2 && nv_p==maxnv) {
+			if (Euler==2 && nv_p>=minnv) {
 				E2++;
-				//if (homRank(vi)!=1) {
-				//	printf("error: homology of a Sphere is: %d\n", homRank(vi));
-				//	exit(1);
-				//}
 			}
-			if (Euler==1 && nv_p==maxnv) {
+			if (Euler==1 && nv_p>=minnv) {
 				E1++;
-				//homology=homRank(vi);
-				//if (homology!=0) {
-				//	printf("error: homology of projective plane is not zero\n");
-				//	exit(1);
-				//}
 			}
-			if (Euler==0 && nv_p==maxnv) {
-				//E0++;
-				homology=homRank(vi);
-				//if (!(homology==1 || homology==0)) {
-				//	printf("homology: %d\n",homology);
-				//	printf("homology of torus or klein is not 1 or 0\n");
-				//	exit(1);
-				//}
-				if (homology==0) {
-					E0_k++;
+			//an odd Euler characteristic is never orientable, so only//
+			//the even ones need orientable_link//
+			if (Euler==0 && nv_p>=minnv) {
+				if (orientable_link(vi)) {
+					E0_t++;
 				}
 				else{
-					E0_t++;
+					E0_k++;
 				}
 			}
 			
-			if (Euler==-1 && nv_p==maxnv) {
+			if (Euler==-1 && nv_p>=minnv) {
 				E91_k++;
 			}
 			//9 vertices is not enough for the orientable surface with Euler=-2//
-			if (Euler==-2 && nv_p==maxnv) {
-				E92_k++;
+			if (Euler==-2 && nv_p>=minnv) {
+				if (orientable_link(vi)) {
+					E92_t++;
+				}
+				else{
+					E92_k++;
+				}
 			}
-			if (Euler==-3 && nv_p==maxnv) {
+			if (Euler==-3 && nv_p>=minnv) {
 				E93_k++;
 			}
-			if (Euler<-3 && nv_p==maxnv) {
-				printf("Euler Char less than -3\n");
-				exit(0);
+			//the file names have no class below E93, and admissable_link//
+			//keeps such links out, so this node is only pruned//
+			if (Euler<-3 && nv_p>=minnv) {
+				remove_tetrahedron_p(type);
+				return FALSE;
 			}
 			 
 		}
@@ -2507,127 +2580,1345 @@ int do_tetrahedron(int v[4], int type)
   
   }
 
-  return TRUE;
+  return TRUE;
+}
+
+int find_candidates(int cand[][4])
+{
+  /* find what the next tetrahedron might be.  
+     the candidates are stored in cand in the order they are to be tried.
+     return the number of candidates. */
+	
+  int v[4];
+  int v2lim,v3lim;
+  int ncand;
+  vset closed01;      /* vertices that can't be v[2], v[3] */
+  vset v2set,v3set;   /* candidates for v[2], v[3] */
+
+  ncand = 0;
+
+  v[0] = list_p[nt_p-1][0];
+  v[1] = list_p[nt_p-1][1];
+  v[2] = list_p[nt_p-1][2];
+  v[3] = list_p[nt_p-1][3]+1;
+
+  	
+
+  /* check if v[0] is complete */
+
+  if (complete_p[v[0]]) {
+	  while (complete_p[v[0]]){
+		  v[0]++;
+	  }
+    v[1] = v[0]+1;
+    v[2] = v[1]+1;
+    v[3] = v[2]+1;
+	
+  }
+	
+
+  /* check if (v[0],v[1]) is complete */
+  //keep this, since//
+  //once an edge becomes complete its link can no longer be connected//
+  //its link does have to be connected//
+  
+  if (complete_edges_p[v[0]] & BIT(v[1])) {
+    while (complete_edges_p[v[0]] & BIT(v[1])){
+		
+      v[1]++;
+	}
+    v[2] = v[1]+1;
+    v[3] = v[2]+1;
+	  
+	 
+  }
+
+  /* while (v[0],v[1]) is not on boundry */
+  
+  while (!(edges_p[v[0]] & BIT(v[1])) || (complete_edges_p[v[0]] & BIT(v[1]))) {
+	  //printf("v[0]: %d, v[1]: %d, v[2]: %d, v[3]: %d \n",v[0],v[1],v[2],v[3]);
+
+    if (!(edges_p[v[0]] & BIT(v[1])) && !complete_p[v[1]]) {
+      
+      /* first use of (v[0],v[1]).  no edge of the tetrahedron may be 
+	 complete and no vertex other than v[0], and the faces at v[2]
+	 must not be full */
+      
+      closed01 = complete_edges_p[v[0]] | complete_edges_p[v[1]] |
+	complete_verts_p;
+      v2lim = MIN(nv_p+1,maxnv-1);
+      v2set = BETWEEN(v[1]+1,v2lim) & ~closed01;
+      while (v2set) {
+	v[2] = FIRSTBIT(v2set);
+	v2set &= v2set-1;
+	v3lim = MIN(MAX(nv_p,v[2]+1)+1,maxnv);
+	v3set = BETWEEN(v[2]+1,v3lim) & ~(closed01 | complete_edges_p[v[2]]);
+	while (v3set) {
+	  v[3] = FIRSTBIT(v3set);
+	  v3set &= v3set-1;
+	  if (!FULLFACE(v[1],v[2],v[3]) && !FULLFACE(v[0],v[2],v[3]))
+	    memcpy(cand[ncand++],v,sizeof(v));
+	}
+      }
+    }
+	  
+    v[1]++;
+    v[2] = v[1]+1;
+    v[3] = v[2]+1;
+    }
+
+  /* while (v[0],v[1],v[2]) is not on boundry */
+
+  while (v[2] < maxnv-1 &&
+	 (BASE(v[0],v[1],v[2])->other_p[0] == -1 ||
+	  BASE(v[0],v[1],v[2])->other_p[1] != -1)) {
+    if (BASE(v[0],v[1],v[2])->other_p[0] == -1 && !complete_p[v[2]]) {
+      
+      /* first use of (v[0],v[1],v[2]).  v[3] is the new vertex nv_p
+	 or an incomplete one, never complete_verts_p */
+
+      v3lim = MIN(MAX(nv_p,v[2]+1)+1,maxnv);
+      v3set = BETWEEN(v[2]+1,v3lim) & ~complete_verts_p;
+      while (v3set) {
+	v[3] = FIRSTBIT(v3set);
+	v3set &= v3set-1;
+	if (!FULLFACE(v[0],v[1],v[3]) && !FULLFACE(v[0],v[2],v[3]) &&
+	    !FULLFACE(v[1],v[2],v[3]))
+	  memcpy(cand[ncand++],v,sizeof(v));
+      }
+    }
+    v[2]++;
+    v[3] = v[2]+1;
+  }
+
+  /* (v[0],v[1],v[2]) is on boundry.  must be used */
+  
+  v3lim = MIN(MAX(nv_p,v[2]+1)+1,maxnv);
+  v3set = BETWEEN(v[3],v3lim) & ~complete_verts_p;
+  while (v3set) {
+    v[3] = FIRSTBIT(v3set);
+    v3set &= v3set-1;
+    if (!FULLFACE(v[0],v[1],v[3]) && !FULLFACE(v[0],v[2],v[3]) &&
+	!FULLFACE(v[1],v[2],v[3]))
+      memcpy(cand[ncand++],v,sizeof(v));
+  }
+
+  return ncand;
+}
+
+void next_tetrahedron()
+{
+  /* a tetrahedron has just been added.  
+     find what the next tetrahedron might be. */
+	
+  int cand[maxcand][4];
+  int ncand,icand;
+
+  if (nt_p == splitlevel && !resuming) {
+#ifdef SPLITTEST
+    splitcases++;
+    return;
+#endif
+    if (nprocs > 0) {
+      send_task();
+      return;
+    }
+    if (splitcount-- != 0) return;
+    splitcount = mod - 1;
+  }
+
+  ncand = find_candidates(cand);
+
+  if (probing) {
+    probe(cand,ncand);
+    return;
+  }
+
+  icand = 0;
+  if (checkpoint_name != NULL) {
+    if (resuming)
+      icand = resume_candidate(cand,ncand);
+    else if (time(NULL) >= next_checkpoint)
+      write_checkpoint();
+  }
+
+  if (nthreads > 1 && 
+      (nt_p <= spawnlevel || __atomic_load_n(&nidle,__ATOMIC_RELAXED) > 0)) {
+    share_candidates(cand,ncand,nt_p);
+    return;
+  }
+
+  for (; icand<ncand; icand++) {
+    do_tetrahedron(cand[icand],PICKED);
+    if (resuming)
+      lost_checkpoint();
+  }
+}
+ 
+/* prefix-targeted search (-p).
+
+   the search is done only below the node of the given tetrahedra.  the 
+   first edge (a,b) of the prefix gives degree0.  every later tetrahedron 
+   must be a candidate of the node before it and keep the list lex-min, so 
+   the node is one the full search reaches. */
+
+static int prefix_nt;             /* number of tetrahedra of the prefix, 0 if
+				     none */
+static int (*prefix_list)[4];    /* [maxlist] */
+
+int read_prefix(char *text)
+{
+  /* read the prefix in lex format.  return degree0, or 0 if the text is not
+     a prefix */
+
+  int i,j,len,degree0;
+  char *p;
+
+  len = strlen(text);
+  if (len == 0 || len % 4 != 0 || len/4 > maxlist)
+    return 0;
+  prefix_nt = len/4;
+  prefix_list = (int (*)[4]) search_table(prefix_nt,sizeof(prefix_list[0]));
+  for (i=0; i<prefix_nt; i++) 
+    for (j=0; j<4; j++) {
+      if ((p = memchr(i2a,text[4*i+j],sizeof(i2a))) == NULL ||
+	  p-i2a >= maxnv)
+	return 0;
+      prefix_list[i][j] = p-i2a;
+    }
+
+  for (degree0=0; degree0<prefix_nt && prefix_list[degree0][0] == 0 &&
+	 prefix_list[degree0][1] == 1; degree0++)
+    ;
+  return degree0;
+}
+
+void bad_prefix(int itet)
+{
+  fprintf(stderr,"tetrahedron %d of the prefix is not reached by the search\n",
+	  itet+1);
+  exit(1);
+}
+
+void enter_prefix(int degree0)
+{
+  /* build the state of the node of the prefix.  every prefix tetrahedron 
+     must be a candidate that passes the checks of the search */
+
+  int cand[maxcand][4];
+  int ncand,icand,itet;
+  bigint save_ncalls;
+
+  initialize_first_edge(degree0);
+  for (itet=0; itet<degree0; itet++)
+    if (memcmp(list_p[itet],prefix_list[itet],sizeof(list_p[itet])) != 0)
+      bad_prefix(itet);
+
+  save_ncalls = ncalls_min_lex;
+  replaying = TRUE;
+  for (itet=degree0; itet<prefix_nt; itet++) {
+    ncand = find_candidates(cand);
+    for (icand=0; icand<ncand &&
+	   memcmp(cand[icand],prefix_list[itet],sizeof(cand[icand])) != 0;
+	 icand++)
+      ;
+    if (icand == ncand)
+      bad_prefix(itet);
+    if (!add_admissable_tetrahedron(prefix_list[itet],PICKED) || !min_lex())
+      bad_prefix(itet);
+  }
+  replaying = FALSE;
+  ncalls_min_lex = save_ncalls;
+}
+
+void start_search(int degree0)
+{
+  /* start at the first edge of degree degree0, or at the node of the 
+     prefix */
+
+  if (prefix_nt > 0)
+    enter_prefix(degree0);
+  else
+    initialize_first_edge(degree0);
+}
+ 
+/* parallel search.
+
+   every thread has a deque of candidates.  a frame of next_tetrahedron with
+   at most spawnlevel tetrahedra, or any frame while a thread is idle, pushes
+   its candidates on the bottom of the deque of its thread and pops them one
+   at a time.  an idle thread steals 
+   the candidate at the top of another deque, which is the oldest and so
+   has the largest subtree.  the thief copies the tetrahedra of the frame,
+   rebuilds the state with replay_prefix and does the candidate.
+
+   the searches for the values of degree0 are shared the same way, as the
+   candidates of a frame with no tetrahedra, so the long search for the 
+   smallest degree0 overlaps with the others.
+
+   the output of a stolen candidate goes into a new chunk placed where one
+   thread would have written it, so the files and counts are the same for
+   any number of threads.  the deques and the chunks are protected by 
+   pool_lock. */
+
+typedef struct frame
+{
+  int nt;              /* number of tetrahedra when the candidates are pushed */
+  chunk *stolen;       /* chunk of the first candidate stolen so far */
+  chunk *resume;       /* chunk for the output after the frame is done */
+} frame;
+
+typedef struct
+{
+  frame *f;
+  int v[4];
+} entry;
+
+typedef struct
+{
+  pthread_t thread;
+  entry *deque;        /* candidates are deque[top] ... deque[bottom-1] */
+  int top,bottom,size;
+  chunk *cur;          /* chunk the thread writes to */
+  int (*list)[4];      /* list_p of the thread */
+  int degree0;         /* degree of the first edge of the thread */
+  int (*prefix)[4];    /* tetrahedra of a stolen frame */
+} worker;
+
+static worker *workers;
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_cond = PTHREAD_COND_INITIALIZER;
+static int nbusy;           /* number of threads not looking for work */
+static chunk *first_chunk;  /* first chunk not yet written */
+static int chunk_closed_link; /* last vi of the chunks written */
+static THREADLOCAL int worker_id;
+
+/* totals of the counts of all threads */
+static int total_mcount;
+static int total_maxEuler;
+static int total_max_inter_nv;
+static bigint total_ngen_all;
+static bigint total_ncalls_min_lex;
+static bigint total_ngenerated[MAXN];
+static bigint total_closed_link[MAXN];
+
+void replay_prefix(int degree0, int nt, int list[][4])
+{
+  /* rebuild the state after the first nt tetrahedra of list.  the 
+     tetrahedra they forced and, with min_lex, completeness and match are
+     rebuilt as they were when the tetrahedra were picked. */
+
+  int itet;
+  bigint save_ncalls;
+
+  initialize_first_edge(degree0);
+
+  save_ncalls = ncalls_min_lex;
+  replaying = TRUE;
+  for (itet=degree0; itet<nt; itet++)
+    if (!add_admissable_tetrahedron(list[itet],PICKED) || !min_lex())
+      bad_prefix(itet);
+  replaying = FALSE;
+  ncalls_min_lex = save_ncalls;
+}
+
+chunk *new_chunk()
+{
+  chunk *c;
+
+  if ((c = (chunk *) calloc(1,sizeof(chunk))) == NULL)
+    error_exit(40);
+  c->first_vi = -1;
+  c->last_vi = -1;
+  return c;
+}
+
+void insert_chunk(chunk *c, chunk *after)
+{
+  /* insert chunk c after chunk after */
+
+  c->prev = after;
+  c->next = after->next;
+  if (after->next != NULL)
+    after->next->prev = c;
+  after->next = c;
+}
+
+void start_chunks()
+{
+  /* keep the output in chunks from now on */
+
+  first_chunk = out_chunk = new_chunk();
+  prev_closed_link = -1;
+  chunk_closed_link = 0;
+}
+
+void write_chunks()
+{
+  /* write the closed chunks at the front of the list */
+
+  chunk *c;
+  FILE *file;
+  int i;
+
+  while (first_chunk != NULL && first_chunk->closed) {
+    c = first_chunk;
+    for (i=0; i<c->nresults; i+=2) {
+      if ((file = fopen(c->results[i],"a")) == NULL) {
+	fprintf(stderr,"can't open %s for writing\n",c->results[i]);
+	exit(1);
+      }
+      fputs(c->results[i+1],file);
+      fclose(file);
+      free(c->results[i]);
+      free(c->results[i+1]);
+    }
+    if (c->first_vi >= 0) {
+      if (c->first_vi > chunk_closed_link)
+	ADDBIG(total_closed_link[c->first_vi],1);
+      chunk_closed_link = c->last_vi;
+    }
+    first_chunk = c->next;
+    if (first_chunk != NULL)
+      first_chunk->prev = NULL;
+    free(c->results);
+    free(c);
+  }
+}
+
+void switch_chunk(chunk *c)
+{
+  /* close the chunk of this thread and continue with chunk c */
+
+  out_chunk->last_vi = prev_closed_link;
+  out_chunk->closed = TRUE;
+  out_chunk = c;
+  if (nthreads > 1)
+    workers[worker_id].cur = c;
+  prev_closed_link = -1;
+  write_chunks();
+}
+
+void do_entry(int nt, int v[4])
+{
+  /* do candidate v of a frame with nt tetrahedra.  with no tetrahedra v[0]
+     is degree0. */
+
+  if (nt == 0) {
+    start_search(v[0]);
+    next_tetrahedron();
+  }
+  else
+    do_tetrahedron(v,PICKED);
+}
+
+void share_candidates(int cand[][4], int ncand, int nt)
+{
+  /* do the candidates of a frame, letting idle threads steal them */
+
+  frame f;
+  worker *w;
+  entry *e;
+  int icand,v[4];
+
+  f.nt = nt;
+  f.stolen = NULL;
+  f.resume = NULL;
+  w = &workers[worker_id];
+
+  pthread_mutex_lock(&pool_lock);
+
+  if (w->top == w->bottom)
+    w->top = w->bottom = 0;
+  if (w->bottom + ncand > w->size) {
+    w->size = 2*(w->bottom + ncand);
+    if ((w->deque = (entry *) realloc(w->deque,w->size*sizeof(entry))) == NULL)
+      error_exit(41);
+  }
+  for (icand=ncand-1; icand>=0; icand--) {
+    e = &w->deque[w->bottom++];
+    e->f = &f;
+    memcpy(e->v,cand[icand],sizeof(e->v));
+  }
+  if (nidle > 0)
+    pthread_cond_broadcast(&pool_cond);
+
+  /* candidates of this frame not yet stolen are at the bottom */
+
+  while (w->bottom > w->top && w->deque[w->bottom-1].f == &f) {
+    w->bottom--;
+    memcpy(v,w->deque[w->bottom].v,sizeof(v));
+    if (nt == 0)
+      w->degree0 = v[0];
+    pthread_mutex_unlock(&pool_lock);
+    do_entry(nt,v);
+    pthread_mutex_lock(&pool_lock);
+  }
+
+  if (f.resume != NULL)
+    switch_chunk(f.resume);
+
+  pthread_mutex_unlock(&pool_lock);
+}
+
+void share_degree0(int min_degree0, int max_degree0)
+{
+  /* do the searches for all values of degree0, letting idle threads steal
+     them */
+
+  int tasks[max_degree0-min_degree0+1][4];
+  int i;
+
+  for (i=0; i<=max_degree0-min_degree0; i++) {
+    tasks[i][0] = min_degree0+i;
+    tasks[i][1] = tasks[i][2] = tasks[i][3] = 0;
+  }
+  share_candidates(tasks,max_degree0-min_degree0+1,0);
+}
+
+void add_counts()
+{
+  /* add the counts of this thread to the totals.  pool_lock is held. */
+
+  int lnv;
+
+  total_mcount += mcount;
+  total_maxEuler = MAX(total_maxEuler,maxEuler);
+  total_max_inter_nv = MAX(total_max_inter_nv,max_inter_nv);
+  SUMBIGS(total_ngen_all,ngen_all);
+  SUMBIGS(total_ncalls_min_lex,ncalls_min_lex);
+  for (lnv=0; lnv<MAXN; lnv++) {
+    SUMBIGS(total_ngenerated[lnv],ngenerated[lnv]);
+    SUMBIGS(total_closed_link[lnv],closed_link[lnv]);
+  }
+}
+
+void run_pool()
+{
+  /* steal candidates from other threads until all threads are done */
+
+  worker *w,*victim;
+  frame *f;
+  entry e;
+  chunk *c;
+  int i,nt;
+
+  w = &workers[worker_id];
+
+  pthread_mutex_lock(&pool_lock);
+  nbusy--;
+
+  for (;;) {
+
+    victim = NULL;
+    for (i=1; i<nthreads && victim == NULL; i++)
+      if (workers[(worker_id+i)%nthreads].bottom > 
+	  workers[(worker_id+i)%nthreads].top)
+	victim = &workers[(worker_id+i)%nthreads];
+
+    if (victim == NULL) {
+      if (nbusy == 0)
+	break;
+      nidle++;
+      pthread_cond_wait(&pool_cond,&pool_lock);
+      nidle--;
+      continue;
+    }
+
+    /* steal the top candidate.  its output goes before the output of the
+       candidates of the same frame stolen before, or directly after the 
+       current output of the victim. */
+
+    e = victim->deque[victim->top++];
+    f = e.f;
+    c = new_chunk();
+    if (f->stolen != NULL)
+      insert_chunk(c,f->stolen->prev);
+    else {
+      insert_chunk(c,victim->cur);
+      f->resume = new_chunk();
+      insert_chunk(f->resume,c);
+    }
+    f->stolen = c;
+
+    /* the victim can not leave the frame while the candidate is in its 
+       deque, so its first f->nt tetrahedra are unchanged */
+
+    nt = f->nt;
+    memcpy(w->prefix,victim->list,nt*sizeof(w->prefix[0]));
+    w->degree0 = nt > 0 ? victim->degree0 : e.v[0];
+    out_chunk = w->cur = c;
+    nbusy++;
+    pthread_mutex_unlock(&pool_lock);
+
+    if (nt > 0)
+      replay_prefix(w->degree0,nt,w->prefix);
+    prev_closed_link = -1;
+    do_entry(nt,e.v);
+
+    pthread_mutex_lock(&pool_lock);
+    switch_chunk(NULL);
+    nbusy--;
+  }
+
+  add_counts();
+  pthread_cond_broadcast(&pool_cond);
+  pthread_mutex_unlock(&pool_lock);
+}
+
+void *run_thread(void *arg)
+{
+  worker_id = (int) (long) arg;
+
+  allocate_search_state();
+  initialize();
+  workers[worker_id].list = list_p;
+
+  run_pool();
+  return NULL;
+}
+
+void start_threads()
+{
+  /* start threads 1, ..., nthreads-1.  this thread is thread 0. */
+
+  int i;
+
+  if ((workers = (worker *) calloc(nthreads,sizeof(worker))) == NULL)
+    error_exit(42);
+  for (i=0; i<nthreads; i++)
+    if ((workers[i].prefix = (int (*)[4]) malloc((maxlist+1)*
+					      sizeof(workers[i].prefix[0])))
+	== NULL)
+      error_exit(42);
+
+  worker_id = 0;
+  workers[0].list = list_p;
+  start_chunks();
+  workers[0].cur = out_chunk;
+  nbusy = nthreads;
+
+  for (i=1; i<nthreads; i++)
+    if (pthread_create(&workers[i].thread,NULL,run_thread,(void *) (long) i)
+	!= 0) {
+      fprintf(stderr,"can't create thread %d\n",i);
+      exit(1);
+    }
+}
+
+void take_totals()
+{
+  /* replace the counts of this thread by the totals */
+
+  int lnv;
+
+  mcount = total_mcount;
+  maxEuler = total_maxEuler;
+  max_inter_nv = total_max_inter_nv;
+  ngen_all = total_ngen_all;
+  ncalls_min_lex = total_ncalls_min_lex;
+  for (lnv=0; lnv<MAXN; lnv++) {
+    ngenerated[lnv] = total_ngenerated[lnv];
+    closed_link[lnv] = total_closed_link[lnv];
+  }
+}
+
+void finish_threads()
+{
+  /* help the other threads until the search is done, then collect the 
+     counts of all threads */
+
+  int i;
+
+  pthread_mutex_lock(&pool_lock);
+  switch_chunk(NULL);
+  pthread_mutex_unlock(&pool_lock);
+
+  run_pool();
+
+  for (i=1; i<nthreads; i++)
+    pthread_join(workers[i].thread,NULL);
+
+  take_totals();
+}
+
+ 
+/* coordinator mode.
+
+   the coordinator (-w) does the search down to splitlevel tetrahedra.  every
+   node at splitlevel is a task: the coordinator sends its tetrahedra to an
+   idle worker process, which rebuilds the state with replay_prefix, does the
+   subtree and sends back its counts and triangulations.  a worker asks for
+   the next task as soon as it is done, so a few large subtrees don't hold
+   up the others.  the results of a task go into a chunk placed where the
+   subtree would have written them, so the files and counts are the same as
+   for the sequential search. */
+
+typedef struct
+{
+  pid_t pid;
+  int task_fd;         /* tasks to the worker */
+  int result_fd;       /* results from the worker */
+  chunk *task;         /* chunk of the task being done, NULL if idle */
+} proc;
+
+static proc *procs;
+static int nfree_procs;     /* number of idle worker processes */
+static int search_degree0;  /* degree of the first edge of the search */
+
+void write_all(int fd, void *buf, size_t len)
+{
+  ssize_t n;
+
+  while (len > 0) {
+    if ((n = write(fd,buf,len)) <= 0) {
+      fprintf(stderr,"can't write to worker process\n");
+      exit(1);
+    }
+    buf = (char *) buf + n;
+    len -= n;
+  }
+}
+
+void read_all(int fd, void *buf, size_t len)
+{
+  ssize_t n;
+
+  while (len > 0) {
+    if ((n = read(fd,buf,len)) <= 0) {
+      fprintf(stderr,"worker process died\n");
+      exit(1);
+    }
+    buf = (char *) buf + n;
+    len -= n;
+  }
+}
+
+void clear_counts()
+{
+  int lnv;
+
+  mcount = 0;
+  maxEuler = 0;
+  max_inter_nv = 0;
+  ZEROBIG(ngen_all);
+  ZEROBIG(ncalls_min_lex);
+  for (lnv=0; lnv<MAXN; lnv++) {
+    ZEROBIG(ngenerated[lnv]);
+    ZEROBIG(closed_link[lnv]);
+  }
+}
+
+void run_worker(int task_fd, int result_fd)
+{
+  /* do the tasks sent by the coordinator until it sends nt = 0 */
+
+  int head[2],ints[6],i;
+  size_t len;
+
+  splitlevel = 0;
+  nprocs = 0;
+
+  for (;;) {
+    read_all(task_fd,head,sizeof(head));
+    if (head[1] == 0)
+      exit(0);
+    read_all(task_fd,list_p,head[1]*sizeof(list_p[0]));
+
+    clear_counts();
+    out_chunk = new_chunk();
+    replay_prefix(head[0],head[1],list_p);
+    prev_closed_link = -1;
+    next_tetrahedron();
+
+    ints[0] = out_chunk->first_vi;
+    ints[1] = prev_closed_link;
+    ints[2] = mcount;
+    ints[3] = maxEuler;
+    ints[4] = max_inter_nv;
+    ints[5] = out_chunk->nresults;
+    write_all(result_fd,ints,sizeof(ints));
+    write_all(result_fd,&ngen_all,sizeof(bigint));
+    write_all(result_fd,&ncalls_min_lex,sizeof(bigint));
+    write_all(result_fd,ngenerated,(maxnv+1)*sizeof(bigint));
+    write_all(result_fd,closed_link,(maxnv+1)*sizeof(bigint));
+    for (i=0; i<out_chunk->nresults; i++) {
+      len = strlen(out_chunk->results[i]);
+      write_all(result_fd,&len,sizeof(len));
+      write_all(result_fd,out_chunk->results[i],len);
+      free(out_chunk->results[i]);
+    }
+    free(out_chunk->results);
+    free(out_chunk);
+  }
+}
+
+void collect_task(proc *p)
+{
+  /* read the results of the task of p into its chunk */
+
+  int ints[6],lnv,i;
+  bigint big,bigs[MAXN];
+  size_t len;
+  char *s;
+  chunk *c;
+
+  c = p->task;
+  read_all(p->result_fd,ints,sizeof(ints));
+  c->first_vi = ints[0];
+  c->last_vi = ints[1];
+  total_mcount += ints[2];
+  total_maxEuler = MAX(total_maxEuler,ints[3]);
+  total_max_inter_nv = MAX(total_max_inter_nv,ints[4]);
+  read_all(p->result_fd,&big,sizeof(bigint));
+  SUMBIGS(total_ngen_all,big);
+  read_all(p->result_fd,&big,sizeof(bigint));
+  SUMBIGS(total_ncalls_min_lex,big);
+  read_all(p->result_fd,bigs,(maxnv+1)*sizeof(bigint));
+  for (lnv=0; lnv<=maxnv; lnv++)
+    SUMBIGS(total_ngenerated[lnv],bigs[lnv]);
+  read_all(p->result_fd,bigs,(maxnv+1)*sizeof(bigint));
+  for (lnv=0; lnv<=maxnv; lnv++)
+    SUMBIGS(total_closed_link[lnv],bigs[lnv]);
+  for (i=0; i<ints[5]; i++) {
+    read_all(p->result_fd,&len,sizeof(len));
+    if ((s = (char *) malloc(len+1)) == NULL)
+      error_exit(43);
+    read_all(p->result_fd,s,len);
+    s[len] = '\0';
+    add_result(c,s);
+  }
+
+  c->closed = TRUE;
+  p->task = NULL;
+  nfree_procs++;
+  write_chunks();
+}
+
+void serve_procs(int timeout)
+{
+  /* collect the results of the tasks that are done, waiting up to timeout 
+     milliseconds (-1 for ever) for one */
+
+  struct pollfd fds[nprocs];
+  int i,n;
+
+  n = 0;
+  for (i=0; i<nprocs; i++)
+    if (procs[i].task != NULL) {
+      fds[n].fd = procs[i].result_fd;
+      fds[n].events = POLLIN;
+      n++;
+    }
+  if (n == 0)
+    return;
+
+  if (poll(fds,n,timeout) < 0) {
+    perror("poll");
+    exit(1);
+  }
+
+  n = 0;
+  for (i=0; i<nprocs; i++)
+    if (procs[i].task != NULL)
+      if (fds[n++].revents != 0)
+	collect_task(&procs[i]);
+}
+
+void send_task()
+{
+  /* give the subtree of the current node to an idle worker process */
+
+  proc *p;
+  int head[2];
+
+  serve_procs(0);
+  while (nfree_procs == 0)
+    serve_procs(-1);
+
+  for (p=procs; p->task != NULL; p++)
+    ;
+  nfree_procs--;
+
+  head[0] = search_degree0;
+  head[1] = nt_p;
+  write_all(p->task_fd,head,sizeof(head));
+  write_all(p->task_fd,list_p,nt_p*sizeof(list_p[0]));
+
+  p->task = new_chunk();
+  insert_chunk(p->task,out_chunk);
+  insert_chunk(new_chunk(),p->task);
+  switch_chunk(p->task->next);
+}
+
+void start_procs()
+{
+  /* fork the worker processes */
+
+  int i,j,task_pipe[2],result_pipe[2];
+
+  if ((procs = (proc *) calloc(nprocs,sizeof(proc))) == NULL)
+    error_exit(43);
+
+  fflush(NULL);
+  for (i=0; i<nprocs; i++) {
+    if (pipe(task_pipe) != 0 || pipe(result_pipe) != 0) {
+      perror("pipe");
+      exit(1);
+    }
+    if ((procs[i].pid = fork()) < 0) {
+      perror("fork");
+      exit(1);
+    }
+    if (procs[i].pid == 0) {
+      for (j=0; j<i; j++) {
+	close(procs[j].task_fd);
+	close(procs[j].result_fd);
+      }
+      close(task_pipe[1]);
+      close(result_pipe[0]);
+      run_worker(task_pipe[0],result_pipe[1]);
+    }
+    close(task_pipe[0]);
+    close(result_pipe[1]);
+    procs[i].task_fd = task_pipe[1];
+    procs[i].result_fd = result_pipe[0];
+  }
+  nfree_procs = nprocs;
+
+  start_chunks();
+}
+
+void finish_procs()
+{
+  /* wait for the last tasks, stop the worker processes and collect the 
+     counts */
+
+  int i,head[2];
+
+  while (nfree_procs < nprocs)
+    serve_procs(-1);
+
+  head[0] = head[1] = 0;
+  for (i=0; i<nprocs; i++) {
+    write_all(procs[i].task_fd,head,sizeof(head));
+    close(procs[i].task_fd);
+    close(procs[i].result_fd);
+  }
+  for (i=0; i<nprocs; i++)
+    waitpid(procs[i].pid,NULL,0);
+
+  switch_chunk(NULL);
+  add_counts();
+  take_totals();
+}
+ 
+/* estimation of the size of the search (-e).
+
+   a probe follows one random candidate at every node of next_tetrahedron
+   from the first edge down to a leaf (Knuth, "Estimating the efficiency of
+   backtrack programs").  a node at depth d of the probe stands for 
+   probe_path[d] nodes, the product of the numbers of candidates above it, 
+   so the average of probe_path[d] over the probes estimates the number of
+   nodes with d tetrahedra.  the sum of probe_path below d divided by
+   probe_path[d] estimates the size of the subtree of the node, from which
+   the mean and variance of the subtree sizes at each depth follow. */
+
+#define JOBS_PER_WORKER 16  /* subtrees wanted at splitlevel per worker */
+
+static double *probe_path; /* probe_weight at each depth, 0 if the probe did
+			      not get there */
+static double *est_nodes;  /* estimated nodes at each depth */
+static double *est_sub;    /* estimated nodes at each depth times */
+static double *est_sub2;   /* their subtree size and its square */
+
+void probe(int cand[][4], int ncand)
+{
+  /* record the current node of the probe and go on with a random candidate */
+
+  probe_path[nt_p] = probe_weight;
+  if (ncand == 0)
+    return;
+  probe_weight *= ncand;
+  do_tetrahedron(cand[random() % ncand],PICKED);
+}
+
+void estimate_degree0(int degree0)
+{
+  /* do the probes starting with the first edge of degree degree0 */
+
+  int i,d;
+  double below;
+
+  for (i=0; i<nprobes; i++) {
+    for (d=0; d<=maxlist; d++)
+      probe_path[d] = 0.0;
+    start_search(degree0);
+    probe_weight = 1.0;
+    next_tetrahedron();
+
+    below = 0.0;
+    for (d=maxlist; d>=0; d--)
+      if (probe_path[d] > 0.0) {
+	below += probe_path[d];
+	est_nodes[d] += probe_path[d]/nprobes;
+	est_sub[d] += below/nprobes;
+	est_sub2[d] += below*below/probe_path[d]/nprobes;
+      }
+  }
+}
+
+int estimate_splitlevel(int min_degree0, int max_degree0, int nworkers,
+			int minlevel, int maxlevel, int hint)
+{
+  /* estimate the search and return the first level with enough subtrees 
+     for nworkers workers, with mean + 3 standard deviations of their sizes 
+     at most half the share of a worker.  return hint if no level has enough subtrees. */
+
+  int degree0,d,level,save_prev_closed_link;
+  double total,mean,var;
+
+  probe_path = (double *) search_table(maxlist+1,sizeof(double));
+  est_nodes = (double *) search_table(maxlist+1,sizeof(double));
+  est_sub = (double *) search_table(maxlist+1,sizeof(double));
+  est_sub2 = (double *) search_table(maxlist+1,sizeof(double));
+
+  save_prev_closed_link = prev_closed_link;
+  probing = TRUE;
+  srandom(1);
+  for (degree0=min_degree0; degree0 <= max_degree0; degree0++)
+    estimate_degree0(degree0);
+  probing = FALSE;
+  prev_closed_link = save_prev_closed_link;
+  clear_counts();
+
+  total = 0.0;
+  for (d=0; d<=maxlist; d++)
+    total += est_nodes[d];
+
+  fprintf(stderr,"estimated %.4g nodes and %.4g triangulations from %d probes\n",
+	  total,est_found,nprobes*(max_degree0-min_degree0+1));
+  fprintf(stderr,"   nt      nodes   subtree mean   variance\n");
+  for (d=0; d<=maxlist; d++)
+    if (est_nodes[d] > 0.0) {
+      mean = est_sub[d]/est_nodes[d];
+      var = MAX(est_sub2[d]/est_nodes[d] - mean*mean,0.0);
+      fprintf(stderr," %4d %10.4g %14.4g %10.4g\n",d,est_nodes[d],mean,var);
+    }
+
+  level = -1;
+  for (d=minlevel; d<=maxlevel && level < 0; d++)
+    if (est_nodes[d] >= JOBS_PER_WORKER*nworkers) {
+      mean = est_sub[d]/est_nodes[d];
+      var = est_sub2[d]/est_nodes[d] - mean*mean;
+      if (mean <= total/(2*nworkers) &&
+	  9*var <= (total/(2*nworkers)-mean)*(total/(2*nworkers)-mean))
+	level = d;
+    }
+  for (d=minlevel; d<=maxlevel && level < 0; d++)
+    if (est_nodes[d] >= JOBS_PER_WORKER*nworkers)
+      level = d;
+  if (level < 0)
+    level = hint;
+
+  fprintf(stderr,"splitlevel %d chosen for %d workers\n",level,nworkers);
+  return level;
+}
+ 
+/* checkpoints (-checkpoint, -resume).
+
+   every CHECKPOINT_INTERVAL seconds the sequential search writes the node
+   it is about to expand (degree0 and the tetrahedra of list_p) and the 
+   counts to the checkpoint file.  the names of the output files and their 
+   sizes before the run first wrote to them are kept in the file name.files,
+   and the checkpoint records their sizes at the time of the checkpoint.
+
+   -resume cuts the output files back to these sizes and walks down the 
+   path of the checkpoint again: at every node of the path the candidates 
+   before the next tetrahedron of the path are skipped, since their subtrees
+   were done before the checkpoint.  at the node of the checkpoint the 
+   counts are restored and the search goes on as usual. */
+
+#define CHECKPOINT_INTERVAL 600  /* seconds between checkpoints */
+
+typedef struct
+{
+  char *name;
+  long initial;        /* size before the run first wrote to the file */
+  long size;           /* size at the checkpoint, -1 if not yet written */
+} outfile;
+
+static outfile *outfiles;
+static int noutfiles,maxoutfiles;
+static FILE *files_journal;       /* the file checkpoint_name.files */
+static int resume_degree0;
+static int resume_nt;
+static int (*resume_list)[4];      /* [maxlist] */
+static int resume_ints[5];         /* mcount, maxEuler, max_inter_nv, 
+				      prev_closed_link, splitcount */
+static bigint resume_bigs[2*MAXN+2];
+
+void add_outfile(char *name, long initial, long size)
+{
+  if (noutfiles == maxoutfiles) {
+    maxoutfiles = 2*maxoutfiles + 16;
+    if ((outfiles = (outfile *) realloc(outfiles,
+					maxoutfiles*sizeof(outfile))) == NULL)
+      error_exit(44);
+  }
+  if ((outfiles[noutfiles].name = strdup(name)) == NULL)
+    error_exit(44);
+  outfiles[noutfiles].initial = initial;
+  outfiles[noutfiles].size = size;
+  noutfiles++;
+}
+
+long file_size(char *name)
+{
+  struct stat st;
+
+  if (stat(name,&st) != 0)
+    return 0;
+  return (long) st.st_size;
 }
 
-void next_tetrahedron()
+void note_outfile(char *name)
 {
-  /* a tetrahedron has just been added.  
-     find what the next tetrahedron might be. */
-	
-  int v[4];
-  int v2lim,v3lim;
+  /* make sure the journal knows the output file name before it is written */
 
-  if (nt_p == splitlevel) {
-#ifdef SPLITTEST
-    splitcases++;
-    return;
-#endif
-    if (splitcount-- != 0) return;
-    splitcount = mod - 1;
-  }
+  int i;
+  long initial;
 
-  v[0] = list_p[nt_p-1][0];
-  v[1] = list_p[nt_p-1][1];
-  v[2] = list_p[nt_p-1][2];
-  v[3] = list_p[nt_p-1][3]+1;
+  for (i=0; i<noutfiles; i++)
+    if (strcmp(outfiles[i].name,name) == 0)
+      return;
 
-  	
+  initial = file_size(name);
+  add_outfile(name,initial,-1);
+  fprintf(files_journal,"%ld %s\n",initial,name);
+  fflush(files_journal);
+  fsync(fileno(files_journal));
+}
 
-  /* check if v[0] is complete */
+void open_journal(char *mode)
+{
+  char name[FILENAME_MAX];
 
-  if (complete_p[v[0]]) {
-	  while (complete_p[v[0]]){
-		  v[0]++;
-	  }
-    v[1] = v[0]+1;
-    v[2] = v[1]+1;
-    v[3] = v[2]+1;
-	
+  sprintf(name,"%.*s.files",FILENAME_MAX-7,checkpoint_name);
+  if ((files_journal = fopen(name,mode)) == NULL) {
+    fprintf(stderr,"can't open %s\n",name);
+    exit(1);
   }
-	
+}
 
-  /* check if (v[0],v[1]) is complete */
-  //keep this, since//
-  //once an edge becomes complete its link can no longer be connected//
-  //its link does have to be connected//
-  
-  if (degree12_p[v[0]][v[1]] == degree13_p[v[0]][v[1]] &&
-      degree12_p[v[0]][v[1]] != 0) {
-    while (degree12_p[v[0]][v[1]] == degree13_p[v[0]][v[1]] &&
-		   degree12_p[v[0]][v[1]] != 0){
-		
-      v[1]++;
-	}
-    v[2] = v[1]+1;
-    v[3] = v[2]+1;
-	  
-	 
+void write_checkpoint()
+{
+  /* write the node about to be expanded and the counts.  the new checkpoint
+     replaces the old one only once it is complete. */
+
+  char tmpname[FILENAME_MAX];
+  FILE *file;
+  int i,fd,lnv;
+
+  for (i=0; i<noutfiles; i++) {
+    outfiles[i].size = file_size(outfiles[i].name);
+    if ((fd = open(outfiles[i].name,O_RDONLY)) >= 0) {
+      fsync(fd);
+      close(fd);
+    }
   }
 
-  /* while (v[0],v[1]) is not on boundry */
-  
-  while (degree12_p[v[0]][v[1]] == 0 || degree12_p[v[0]][v[1]] == degree13_p[v[0]][v[1]]) {
-	  //printf("v[0]: %d, v[1]: %d, v[2]: %d, v[3]: %d \n",v[0],v[1],v[2],v[3]);
+  sprintf(tmpname,"%.*s.tmp",FILENAME_MAX-5,checkpoint_name);
+  if ((file = fopen(tmpname,"w")) == NULL) {
+    fprintf(stderr,"can't open %s for writing\n",tmpname);
+    exit(1);
+  }
+  fprintf(file,"lextet %s checkpoint\n",VERSION);
+  fprintf(file,"%d %d %d %d %d %d %d %d %d\n",maxnv,only_irreducible,
+	  only_manifolds,only_exact,minnv,link_kind,res,mod,splitlevel);
+  for (i=0; i<NSIGNATURE; i++)
+    fprintf(file,"%d %d ",sig_lo[i],sig_hi[i]);
+  fprintf(file,"\n%d %d\n",search_degree0,nt_p);
+  for (i=0; i<nt_p; i++)
+    fprintf(file,"%d %d %d %d\n",
+	    list_p[i][0],list_p[i][1],list_p[i][2],list_p[i][3]);
+  fprintf(file,"%d %d %d %d %d\n",
+	  mcount,maxEuler,max_inter_nv,prev_closed_link,splitcount);
+  fprintf(file,"%ld %ld\n",ngen_all.hi,ngen_all.lo);
+  fprintf(file,"%ld %ld\n",ncalls_min_lex.hi,ncalls_min_lex.lo);
+  for (lnv=0; lnv<MAXN; lnv++)
+    fprintf(file,"%ld %ld %ld %ld\n",ngenerated[lnv].hi,ngenerated[lnv].lo,
+	    closed_link[lnv].hi,closed_link[lnv].lo);
+  fprintf(file,"%d\n",noutfiles);
+  for (i=0; i<noutfiles; i++)
+    fprintf(file,"%ld %s\n",outfiles[i].size,outfiles[i].name);
+  fflush(file);
+  if (ferror(file) || fsync(fileno(file)) != 0) {
+    fprintf(stderr,"can't write %s\n",tmpname);
+    exit(1);
+  }
+  fclose(file);
+  if (rename(tmpname,checkpoint_name) != 0) {
+    fprintf(stderr,"can't rename %s to %s\n",tmpname,checkpoint_name);
+    exit(1);
+  }
 
-    if (degree12_p[v[0]][v[1]] == 0 && !complete_p[v[1]]) {
-      
-      /* first use of (v[0],v[1]) */
-      
-      v2lim = MIN(nv_p+1,maxnv-1);
-      for (v[2]=v[1]+1; v[2]<v2lim; v[2]++)
-		  if ((degree12_p[v[0]][v[2]] == 0 || degree12_p[v[0]][v[2]] != degree13_p[v[0]][v[2]]) && 
-			  (degree12_p[v[1]][v[2]] == 0 || degree12_p[v[1]][v[2]] != degree13_p[v[1]][v[2]]) &&
-			  (v[2] == nv_p || !complete_p[v[2]])) {
-				v3lim = MIN(MAX(nv_p,v[2]+1)+1,maxnv);
-				for (v[3]=v[2]+1; v[3]<v3lim; v[3]++)
-					if ((degree12_p[v[0]][v[3]] == 0 || degree12_p[v[0]][v[3]] != degree13_p[v[0]][v[3]]) &&
-						(degree12_p[v[1]][v[3]] == 0 || degree12_p[v[1]][v[3]] != degree13_p[v[1]][v[3]]) &&
-						(degree12_p[v[2]][v[3]] == 0 || degree12_p[v[2]][v[3]] != degree13_p[v[2]][v[3]]) &&
-						(base[v[1]][v[2]][v[3]]->other_p[1] == -1) && (base[v[0]][v[2]][v[3]]->other_p[1] == -1) && 
-						(v[3] >= nv_p || !complete_p[v[3]]))
-							do_tetrahedron(v,PICKED);
-		  }
-    }
-	  
-    v[1]++;
-    v[2] = v[1]+1;
-    v[3] = v[2]+1;
+  next_checkpoint = time(NULL) + CHECKPOINT_INTERVAL;
+}
+
+void bad_checkpoint(char *name)
+{
+  fprintf(stderr,"%s is not a checkpoint of this search\n",name);
+  exit(1);
+}
+
+int same_signature(FILE *file)
+{
+  /* read the ranges of -sig of a checkpoint and compare them with ours */
+
+  int i,lo,hi;
+
+  for (i=0; i<NSIGNATURE; i++)
+    if (fscanf(file,"%d %d",&lo,&hi) != 2 || lo != sig_lo[i] || 
+	hi != sig_hi[i])
+      return FALSE;
+  return TRUE;
+}
+
+void read_checkpoint(char *name)
+{
+  /* read the checkpoint, cut the output files back and set up the walk 
+     down to the node of the checkpoint */
+
+  FILE *file;
+  char version[20],outname[FILENAME_MAX];
+  int i,n,ints[9];
+  long size,initial;
+
+  if ((file = fopen(name,"r")) == NULL) {
+    fprintf(stderr,"can't open %s\n",name);
+    exit(1);
+  }
+  if (fscanf(file,"lextet %19s checkpoint",version) != 1 ||
+      strcmp(version,VERSION) != 0 ||
+      fscanf(file,"%d %d %d %d %d %d %d %d %d",&ints[0],&ints[1],&ints[2],
+	     &ints[3],&ints[4],&ints[5],&ints[6],&ints[7],&ints[8]) != 9 ||
+      ints[0] != maxnv || ints[1] != only_irreducible || 
+      ints[2] != only_manifolds || ints[3] != only_exact || 
+      ints[4] != minnv || ints[5] != link_kind || ints[6] != res || 
+      ints[7] != mod || ints[8] != splitlevel || !same_signature(file) ||
+      fscanf(file,"%d %d",&resume_degree0,&resume_nt) != 2 ||
+      resume_nt < resume_degree0 || resume_nt > maxlist)
+    bad_checkpoint(name);
+  resume_list = (int (*)[4]) search_table(resume_nt+1,sizeof(resume_list[0]));
+  for (i=0; i<resume_nt; i++)
+    if (fscanf(file,"%d %d %d %d",&resume_list[i][0],&resume_list[i][1],
+	       &resume_list[i][2],&resume_list[i][3]) != 4)
+      bad_checkpoint(name);
+  for (i=0; i<5; i++)
+    if (fscanf(file,"%d",&resume_ints[i]) != 1)
+      bad_checkpoint(name);
+  for (i=0; i<2*MAXN+2; i++)
+    if (fscanf(file,"%ld %ld",&resume_bigs[i].hi,&resume_bigs[i].lo) != 2)
+      bad_checkpoint(name);
+  if (fscanf(file,"%d",&n) != 1)
+    bad_checkpoint(name);
+  for (i=0; i<n; i++)
+    if (fscanf(file,"%ld %s",&size,outname) != 2)
+      bad_checkpoint(name);
+    else
+      add_outfile(outname,-1,size);
+  fclose(file);
+
+  /* files first written after the checkpoint go back to their size before
+     the run */
+
+  open_journal("r");
+  while (fscanf(files_journal,"%ld %s",&initial,outname) == 2) {
+    for (i=0; i<noutfiles; i++)
+      if (strcmp(outfiles[i].name,outname) == 0)
+	break;
+    if (i == noutfiles)
+      add_outfile(outname,initial,initial);
+    else if (outfiles[i].initial < 0)
+      outfiles[i].initial = initial;
+  }
+  fclose(files_journal);
+
+  for (i=0; i<noutfiles; i++)
+    if (file_size(outfiles[i].name) < outfiles[i].size ||
+	truncate(outfiles[i].name,outfiles[i].size) != 0) {
+      fprintf(stderr,"can't cut %s back to %ld bytes\n",outfiles[i].name,
+	      outfiles[i].size);
+      exit(1);
     }
 
-  /* while (v[0],v[1],v[2]) is not on boundry */
+  resuming = TRUE;
+  replaying = TRUE;
+  fprintf(stderr,"resuming at %d tetrahedra with degree0 = %d\n",resume_nt,
+	  resume_degree0);
+}
 
-  while (v[2] < maxnv-1 &&
-	 (base[v[0]][v[1]][v[2]]->other_p[0] == -1 ||
-	  base[v[0]][v[1]][v[2]]->other_p[1] != -1)) {
-    if (base[v[0]][v[1]][v[2]]->other_p[0] == -1 && !complete_p[v[2]]) {
-      
-      /* first use of (v[0],v[1],v[2]) */
+void start_checkpoints()
+{
+  open_journal(resuming ? "a" : "w");
+  next_checkpoint = time(NULL) + CHECKPOINT_INTERVAL;
+}
 
-      v3lim = MIN(MAX(nv_p,v[2]+1)+1,maxnv);
-      for (v[3]=v[2]+1; v[3]<v3lim; v[3]++)
-	if ((base[v[0]][v[1]][v[3]]->other_p[1] == -1) &&
-	    (base[v[0]][v[2]][v[3]]->other_p[1] == -1) &&
-	    (base[v[1]][v[2]][v[3]]->other_p[1] == -1) &&
-	    (v[3] == nv_p || !complete_p[v[3]]))
-	  do_tetrahedron(v,PICKED);
+void finish_checkpoints()
+{
+  /* the search is complete.  the checkpoint is of no use any more. */
+
+  char name[FILENAME_MAX];
+
+  fclose(files_journal);
+  sprintf(name,"%.*s.files",FILENAME_MAX-7,checkpoint_name);
+  remove(name);
+  remove(checkpoint_name);
+}
+
+void lost_checkpoint()
+{
+  fprintf(stderr,"the search does not reach the node of the checkpoint\n");
+  exit(1);
+}
+
+int resume_candidate(int cand[][4], int ncand)
+{
+  /* return the position of the next tetrahedron of the path of the 
+     checkpoint among the candidates.  at the node of the checkpoint 
+     restore the counts and return 0. */
+
+  int icand,i,lnv;
+
+  if (nt_p == resume_nt) {
+    resuming = FALSE;
+    replaying = FALSE;
+    mcount = resume_ints[0];
+    maxEuler = resume_ints[1];
+    max_inter_nv = resume_ints[2];
+    prev_closed_link = resume_ints[3];
+    splitcount = resume_ints[4];
+    ngen_all = resume_bigs[0];
+    ncalls_min_lex = resume_bigs[1];
+    for (lnv=0; lnv<MAXN; lnv++) {
+      ngenerated[lnv] = resume_bigs[2+2*lnv];
+      closed_link[lnv] = resume_bigs[3+2*lnv];
     }
-    v[2]++;
-    v[3] = v[2]+1;
+    return 0;
   }
 
-  /* (v[0],v[1],v[2]) is on boundry.  must be used */
-  
-  v3lim = MIN(MAX(nv_p,v[2]+1)+1,maxnv);
-  for (; v[3]<v3lim; v[3]++)
-    if ((base[v[0]][v[1]][v[3]]->other_p[1] == -1) &&
-	(base[v[0]][v[2]][v[3]]->other_p[1] == -1) &&
-	(base[v[1]][v[2]][v[3]]->other_p[1] == -1) &&
-	(v[3] == nv_p || !complete_p[v[3]]))
-      do_tetrahedron(v,PICKED);
+  for (icand=0; icand<ncand; icand++) {
+    for (i=0; i<4 && cand[icand][i] == resume_list[nt_p][i]; i++)
+      ;
+    if (i == 4)
+      return icand;
+  }
 
+  lost_checkpoint();
+  return ncand;
 }
- 
+
 static void
 initialize_splitting(int minlevel, int hint, int maxlevel)
   
@@ -2641,7 +3932,7 @@ initialize_splitting(int minlevel, int hint, int maxlevel)
       if (minlevel <= maxlevel) splitlevel = minlevel;
       else                      splitlevel = 0;
     }
-  if (mod == 1) splitlevel = 0;
+  if (mod == 1 && nprocs == 0) splitlevel = 0;
   splitcount = res;
 }
 
@@ -2719,6 +4010,7 @@ char *argv[];
   int hint;
   int degree0,min_degree0,max_degree0;
   int res_digits;
+  char *resume_name,*prefix;
 
 #if CPUTIME
   struct tms timestruct0,timestruct1;
@@ -2728,9 +4020,22 @@ char *argv[];
  
   gdefined = FALSE;
   only_irreducible = FALSE;
+  link_kind = 0;
+  only_manifolds = FALSE;
+  only_exact = FALSE;
+  minnv = 0;
+  use_sig = FALSE;
+  for (iarg=0; iarg<NSIGNATURE; iarg++) {
+    sig_lo[iarg] = -SIG_ANY;
+    sig_hi[iarg] = SIG_ANY;
+  }
   maxnv = 0;
   res = 0;
   mod = 1;
+  nthreads = 1;
+  nprocs = 0;
+  nprobes = 0;
+  checkpoint_name = resume_name = prefix = NULL;
   badargs = FALSE;
 
   for (iarg = 0; iarg < argc ; ++iarg) fprintf(stderr,"%s ",argv[iarg]);
@@ -2779,10 +4084,141 @@ char *argv[];
 	}
       }
     }
+    else if (strcmp(arg,"-t") == 0) {
+      iarg++;
+      if (iarg >= argc) {
+	fprintf(stderr,"number of threads required after -t switch\n");
+	badargs = TRUE;
+      }
+      else {
+	nthreads = getargvalue(argv[iarg]);
+	iarg++;
+	if (nthreads < 1) {
+	  fprintf(stderr,"number of threads (%d) must be positive.\n",nthreads);
+	  badargs = TRUE;
+	  nthreads = 1;
+	}
+      }
+    }
+    else if (strcmp(arg,"-w") == 0) {
+      iarg++;
+      if (iarg >= argc) {
+	fprintf(stderr,"number of processes required after -w switch\n");
+	badargs = TRUE;
+      }
+      else {
+	nprocs = getargvalue(argv[iarg]);
+	iarg++;
+	if (nprocs < 0) {
+	  fprintf(stderr,"number of processes (%d) must be non-negative.\n",
+		  nprocs);
+	  badargs = TRUE;
+	  nprocs = 0;
+	}
+      }
+    }
+    else if (strcmp(arg,"-e") == 0) {
+      iarg++;
+      if (iarg >= argc) {
+	fprintf(stderr,"number of probes required after -e switch\n");
+	badargs = TRUE;
+      }
+      else {
+	nprobes = getargvalue(argv[iarg]);
+	iarg++;
+	if (nprobes < 0) {
+	  fprintf(stderr,"number of probes (%d) must be non-negative.\n",
+		  nprobes);
+	  badargs = TRUE;
+	  nprobes = 0;
+	}
+      }
+    }
+    else if (strcmp(arg,"-checkpoint") == 0) {
+      iarg++;
+      if (iarg >= argc) {
+	fprintf(stderr,"file name required after -checkpoint switch\n");
+	badargs = TRUE;
+      }
+      else
+	checkpoint_name = argv[iarg++];
+    }
+    else if (strcmp(arg,"-resume") == 0) {
+      iarg++;
+      if (iarg >= argc) {
+	fprintf(stderr,"file name required after -resume switch\n");
+	badargs = TRUE;
+      }
+      else
+	resume_name = argv[iarg++];
+    }
+    else if (strcmp(arg,"-p") == 0) {
+      iarg++;
+      if (iarg >= argc) {
+	fprintf(stderr,"tetrahedra required after -p switch\n");
+	badargs = TRUE;
+      }
+      else
+	prefix = argv[iarg++];
+    }
     else if (strcmp(arg,"-i") == 0) {
       only_irreducible = TRUE;
       iarg++;
     }
+    else if (strcmp(arg,"-manifold") == 0) {
+      only_manifolds = TRUE;
+      iarg++;
+    }
+    else if (strcmp(arg,"-exact") == 0) {
+      only_exact = TRUE;
+      iarg++;
+    }
+    else if (strcmp(arg,"-from") == 0) {
+      iarg++;
+      if (iarg >= argc) {
+	fprintf(stderr,"number of vertices required after -from switch\n");
+	badargs = TRUE;
+      }
+      else {
+	minnv = getargvalue(argv[iarg]);
+	iarg++;
+	if (minnv < 4) {
+	  fprintf(stderr,"-from number of vertices (%d) too small.\n",minnv);
+	  badargs = TRUE;
+	}
+      }
+    }
+    else if (strcmp(arg,"-sig") == 0) {
+      iarg++;
+      if (iarg >= argc) {
+	fprintf(stderr,"ranges required after -sig switch\n");
+	badargs = TRUE;
+      }
+      else {
+	if (!read_signature(argv[iarg])) {
+	  fprintf(stderr,"bad ranges %s after -sig switch.\n",argv[iarg]);
+	  badargs = TRUE;
+	}
+	use_sig = TRUE;
+	iarg++;
+      }
+    }
+    else if (strcmp(arg,"-l") == 0) {
+      iarg++;
+      if (iarg >= argc) {
+	fprintf(stderr,"t or k required after -l switch\n");
+	badargs = TRUE;
+      }
+      else {
+	if (strcmp(argv[iarg],"t") == 0 || strcmp(argv[iarg],"k") == 0)
+	  link_kind = argv[iarg][0];
+	else {
+	  fprintf(stderr,"-l switch takes t or k, not %s.\n",argv[iarg]);
+	  badargs = TRUE;
+	}
+	iarg++;
+      }
+    }
     else {
       if (maxnv > 0) {
 	fprintf(stderr,"redefining nv\n");
@@ -2808,7 +4244,14 @@ char *argv[];
   }
 
   if (maxnv > MAXN) {
-    fprintf(stderr,"nv (%d) too large.  increase MAXN.\n",maxnv);
+    fprintf(stderr,"nv (%d) too large (at most %d).\n",maxnv,MAXN);
+    badargs = TRUE;
+  }
+
+  if (minnv == 0)
+    minnv = maxnv;
+  else if (minnv > maxnv) {
+    fprintf(stderr,"-from number of vertices (%d) > nv (%d).\n",minnv,maxnv);
     badargs = TRUE;
   }
 
@@ -2819,6 +4262,31 @@ char *argv[];
     mod = 1;
   }
 
+  if (nthreads > 1 && mod != 1) {
+    fprintf(stderr,"res/mod splitting can't be used with threads.\n");
+    badargs = TRUE;
+  }
+
+  if (resume_name != NULL && checkpoint_name == NULL)
+    checkpoint_name = resume_name;
+
+  if (prefix != NULL && checkpoint_name != NULL) {
+    fprintf(stderr,"a prefix can't be used with checkpoints.\n");
+    badargs = TRUE;
+  }
+
+  if (checkpoint_name != NULL && (nthreads > 1 || nprocs > 0)) {
+    fprintf(stderr,
+	    "checkpoints can't be used with threads or worker processes.\n");
+    badargs = TRUE;
+  }
+
+  if (nprocs > 0 && (nthreads > 1 || mod != 1)) {
+    fprintf(stderr,
+	    "worker processes can't be used with threads or res/mod splitting.\n");
+    badargs = TRUE;
+  }
+
   maxne = maxnv*(maxnv-1)/2;
 
   if (maxne > MAXE) {
@@ -2840,12 +4308,7 @@ char *argv[];
   maxnt = maxne - maxnv; //This is because of the Euler characteristic//
 						 //Will be different for pseudomanifolds//
 
-  if (maxnt > MAXT) {
-    fprintf(stderr,
-	    "maximum number of tetrahedra (%d) too large. increase MAXT.\n",
-	    maxnt);
-    badargs = TRUE;
-  }
+  maxlist = maxnf/2;
 
   if (badargs) {
     fprintf(stderr,"Usage: %s\n",USAGE);
@@ -2854,6 +4317,8 @@ char *argv[];
   
 #ifdef SPLITTEST
   if (mod == 1) mod = 2;
+  nthreads = 1;
+  nprocs = 0;
 #endif
 
   if (verbose) {
@@ -2862,33 +4327,94 @@ char *argv[];
     fprintf(stderr,"Maximum number of tetrahedra: %d\n", maxnt);
     if (only_irreducible)
       fprintf(stderr,"Only irreducible triangulations are generated.\n");
+    if (only_manifolds)
+      fprintf(stderr,"Only 3-manifolds are generated.\n");
+    if (minnv < maxnv)
+      fprintf(stderr,"Triangulations with %d to %d vertices are written.\n",
+	      minnv,maxnv);
+    if (only_exact)
+      fprintf(stderr,
+	      "Only triangulations with %d or more vertices are searched.\n",
+	      minnv);
+    if (link_kind == 't')
+      fprintf(stderr,"Only orientable vertex links.\n");
+    if (link_kind == 'k')
+      fprintf(stderr,"Only non-orientable singular vertex links.\n");
+    if (use_sig)
+      fprintf(stderr,"Only the signatures in the ranges of -sig.\n");
     fprintf(stderr,"res/mod = %d/%d\n",res,mod);
+    if (nthreads > 1)
+      fprintf(stderr,"%d threads\n",nthreads);
+    if (nprocs > 0)
+      fprintf(stderr,"%d worker processes\n",nprocs);
+  }
+
+  maxcand = (maxnv-1)*(maxnv-2)*(maxnv-3)/6;
+
+  make_face_index();
+  allocate_search_state();
+  initialize();
+
+  min_degree0 = 3;
+  max_degree0 = maxnv-2;
+  if (only_irreducible)
+    max_degree0 = MIN(maxnv-3,max_degree0);
+
+  if (prefix != NULL) {
+    degree0 = read_prefix(prefix);
+    if (degree0 < min_degree0 || degree0 > max_degree0) {
+      fprintf(stderr,"%s is not a prefix of the search.\n",prefix);
+      exit(1);
+    }
+    min_degree0 = max_degree0 = degree0;
   }
 
   hint = MIN(maxnt/2, 54);
+  if (nprobes > 0)
+    hint = estimate_splitlevel(min_degree0,max_degree0,
+			       MAX(MAX(nthreads,nprocs),mod),4,maxnt-1,hint);
 
   initialize_splitting(4,hint,maxnt-1);
 
-  if (verbose && mod != 1)
+  if (verbose && (mod != 1 || nprocs > 0))
     fprintf(stderr,"splitlevel is at %d tetrahedra.\n",splitlevel);
 
+  spawnlevel = hint;
+
   sprintf(res_text,"%d",mod-1);
   res_digits = strlen(res_text);
   sprintf(res_text,"%c%d.%dd",'%',res_digits,res_digits);
   sprintf(res_text,res_text,res);
 
-  initialize();
-
-  min_degree0 = 3;
-  max_degree0 = maxnv-2;
-  if (only_irreducible)
-    max_degree0 = MIN(maxnv-3,max_degree0);
+  if (resume_name != NULL) {
+    read_checkpoint(resume_name);
+    if (resume_degree0 < min_degree0 || resume_degree0 > max_degree0)
+      bad_checkpoint(resume_name);
+    min_degree0 = resume_degree0;
+  }
+  if (checkpoint_name != NULL)
+    start_checkpoints();
+  if (nthreads > 1)
+    start_threads();
+  if (nprocs > 0)
+    start_procs();
 	
-  for (degree0=min_degree0; degree0 <= max_degree0; degree0++) {
-    initialize_first_edge(degree0);
+  if (nthreads > 1)
+    share_degree0(min_degree0,max_degree0);
+  else
+    for (degree0=min_degree0; degree0 <= max_degree0; degree0++) {
+      search_degree0 = degree0;
+      start_search(degree0);
     
-    next_tetrahedron();
-  }
+      next_tetrahedron();
+    }
+
+  if (nthreads > 1)
+    finish_threads();
+  if (nprocs > 0)
+    finish_procs();
+  if (checkpoint_name != NULL)
+    finish_checkpoints();
 
 #if CPUTIME
   times(&timestruct1);